@@ -0,0 +1,434 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include "../include/core/basic_simulator.hpp"
+#include "../include/core/optimizer.hpp"
+#include "../include/core/simulator.hpp"
+#include "../include/core/environment.hpp"
+#include "../include/core/vector3.hpp"
+#include "../include/utils/config.hpp"
+#include "../include/utils/logger.hpp"
+
+// Run with --benchmark_out=results.json --benchmark_out_format=json for the
+// machine-readable report. Build in Release; the numbers mean little otherwise.
+// The benchmarks that check a property as well (BM_EvaluateCandidate,
+// BM_AdaptiveStepInterval) make the process exit with 1 when it does not hold;
+// ctest runs just those.
+
+using namespace sim::core;
+using namespace sim::utils;
+
+// Every heap allocation of the process goes through the replacements below, so
+// a benchmark can report how many happened while it was timed. All of the
+// replaceable forms are covered: plain, array, nothrow and over-aligned (as for
+// the 32-byte Vector3 of PADDED_VECTOR3).
+namespace
+{
+    std::atomic<std::uint64_t> allocationCount{0};
+
+    void *countedAllocate(std::size_t size, std::size_t alignment) noexcept
+    {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        size = size ? size : 1;
+        if (alignment <= alignof(std::max_align_t))
+        {
+            return std::malloc(size);
+        }
+        // aligned_alloc wants a multiple of the alignment
+        return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    }
+
+    void *countedAllocateOrThrow(std::size_t size, std::size_t alignment)
+    {
+        if (void *p = countedAllocate(size, alignment))
+        {
+            return p;
+        }
+        throw std::bad_alloc();
+    }
+
+    // Not inlined, so the compiler never pairs a free() with the operator new it
+    // came from
+    [[gnu::noinline]] void countedFree(void *p) noexcept
+    {
+        std::free(p);
+    }
+
+    constexpr std::size_t DEFAULT_ALIGNMENT = alignof(std::max_align_t);
+}
+
+void *operator new(std::size_t size) { return countedAllocateOrThrow(size, DEFAULT_ALIGNMENT); }
+void *operator new[](std::size_t size) { return countedAllocateOrThrow(size, DEFAULT_ALIGNMENT); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return countedAllocate(size, DEFAULT_ALIGNMENT); }
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return countedAllocate(size, DEFAULT_ALIGNMENT); }
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    return countedAllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return countedAllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return countedAllocate(size, static_cast<std::size_t>(alignment));
+}
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return countedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *p) noexcept { countedFree(p); }
+void operator delete[](void *p) noexcept { countedFree(p); }
+void operator delete(void *p, std::size_t) noexcept { countedFree(p); }
+void operator delete[](void *p, std::size_t) noexcept { countedFree(p); }
+void operator delete(void *p, const std::nothrow_t &) noexcept { countedFree(p); }
+void operator delete[](void *p, const std::nothrow_t &) noexcept { countedFree(p); }
+void operator delete(void *p, std::align_val_t) noexcept { countedFree(p); }
+void operator delete[](void *p, std::align_val_t) noexcept { countedFree(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { countedFree(p); }
+void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { countedFree(p); }
+void operator delete(void *p, std::align_val_t, const std::nothrow_t &) noexcept { countedFree(p); }
+void operator delete[](void *p, std::align_val_t, const std::nothrow_t &) noexcept { countedFree(p); }
+
+namespace
+{
+    // The scenario of main.cpp
+    const Vector3 DESTINATION(90000, 100000.0 + config::EARTH_RADIUS, 40000);
+    constexpr int OPTIMIZER_ITERATIONS = 100;
+
+    // Best vehicle of the main.cpp optimizer run, found once
+    Optimizer &mainScenarioOptimizer()
+    {
+        static Optimizer optimizer(std::make_shared<Environment>(), DESTINATION, Optimizer::DEFAULT_SEED);
+        if (optimizer.evaluationCount() == 0)
+        {
+            optimizer.optimize(OPTIMIZER_ITERATIONS);
+        }
+        return optimizer;
+    }
+
+    EnvironmentModel modelArg(const benchmark::State &state)
+    {
+        return static_cast<EnvironmentModel>(state.range(0));
+    }
+
+    void setAllocationCounter(benchmark::State &state, std::uint64_t allocations, double runs)
+    {
+        state.counters["allocs_per_run"] = benchmark::Counter(static_cast<double>(allocations) / runs);
+    }
+
+    // Set by failCheck(); main() then exits with 1, which is what CTest sees
+    bool checkFailed = false;
+
+    void failCheck(benchmark::State &state, const char *message)
+    {
+        checkFailed = true;
+        state.SkipWithError(message);
+    }
+}
+
+// Vector3
+
+static void BM_Vector3Arithmetic(benchmark::State &state)
+{
+    Vector3 a(1.0, 2.0, 3.0), b(-0.5, 0.25, 4.0);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(b);
+        Vector3 c = (a + b) * 0.5 - a / 3.0;
+        benchmark::DoNotOptimize(c);
+    }
+}
+BENCHMARK(BM_Vector3Arithmetic);
+
+static void BM_Vector3DotCross(benchmark::State &state)
+{
+    Vector3 a(1.0, 2.0, 3.0), b(-0.5, 0.25, 4.0);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(b);
+        benchmark::DoNotOptimize(a.dot(b));
+        benchmark::DoNotOptimize(a.cross(b));
+    }
+}
+BENCHMARK(BM_Vector3DotCross);
+
+static void BM_Vector3Normalize(benchmark::State &state)
+{
+    Vector3 a(1.0, 2.0, 3.0);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(a);
+        benchmark::DoNotOptimize(a.normalized());
+    }
+}
+BENCHMARK(BM_Vector3Normalize);
+
+// Environment, argument = EnvironmentModel
+
+static void BM_GravityForce(benchmark::State &state)
+{
+    Environment env(modelArg(state));
+    Rocket rocket(1000, 4000, 20, 300, 10.0, 0.2);
+    rocket.setPosition(Vector3(1000.0, config::EARTH_RADIUS + 35000.0, 2000.0));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(env.computeGravityForce(rocket));
+    }
+}
+BENCHMARK(BM_GravityForce)->DenseRange(0, 2);
+
+static void BM_DragForce(benchmark::State &state)
+{
+    Environment env(modelArg(state));
+    Rocket rocket(1000, 4000, 20, 300, 10.0, 0.2);
+    rocket.setPosition(Vector3(1000.0, config::EARTH_RADIUS + 35000.0, 2000.0));
+    rocket.setVelocity(Vector3(300.0, 900.0, 100.0));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(env.computeDragForce(rocket));
+    }
+}
+BENCHMARK(BM_DragForce)->DenseRange(0, 2);
+
+// Simulator
+
+static void BM_SimulatorStep(benchmark::State &state)
+{
+    auto env = std::make_shared<Environment>(modelArg(state));
+    auto makeSimulator = [&]
+    {
+        auto rocket = std::make_shared<Rocket>(1000, 4000, 20, 300, 10.0, 0.2);
+        auto autopilot = std::make_shared<GravityTurnAutopilot>(60000.0, DESTINATION, env, 2000.0, 0.5, 8.0);
+        return std::make_unique<Simulator>(rocket, env, DESTINATION, autopilot);
+    };
+
+    auto simulator = makeSimulator();
+    std::uint64_t allocations = 0;
+    for (auto _ : state)
+    {
+        if (simulator->rocket().isOutOfFuel())
+        {
+            state.PauseTiming();
+            simulator = makeSimulator();
+            state.ResumeTiming();
+        }
+        std::uint64_t before = allocationCount.load(std::memory_order_relaxed);
+        simulator->step(config::TIME_STEP);
+        allocations += allocationCount.load(std::memory_order_relaxed) - before;
+    }
+
+    double steps = static_cast<double>(state.iterations());
+    state.counters["steps_per_second"] = benchmark::Counter(steps, benchmark::Counter::kIsRate);
+    state.counters["allocs_per_step"] = benchmark::Counter(static_cast<double>(allocations) / steps);
+}
+BENCHMARK(BM_SimulatorStep)->DenseRange(0, 2);
+
+// Full run of the main.cpp vehicle, argument = Simulator::Integrator
+static void BM_SimulatorRun(benchmark::State &state)
+{
+    Optimizer &optimizer = mainScenarioOptimizer();
+    auto integrator = static_cast<Simulator::Integrator>(state.range(0));
+
+    std::uint64_t steps = 0, allocations = 0;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto simulator = optimizer.createOptimizedSimulator();
+        simulator->setIntegrator(integrator);
+        std::uint64_t before = allocationCount.load(std::memory_order_relaxed);
+        state.ResumeTiming();
+
+        simulator->run();
+
+        allocations += allocationCount.load(std::memory_order_relaxed) - before;
+        steps += simulator->stepCount();
+    }
+
+    double runs = static_cast<double>(state.iterations());
+    state.counters["steps_per_run"] = benchmark::Counter(static_cast<double>(steps) / runs);
+    state.counters["steps_per_second"] = benchmark::Counter(static_cast<double>(steps), benchmark::Counter::kIsRate);
+    state.counters["time_per_step"] = benchmark::Counter(static_cast<double>(steps),
+                                                         benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    setAllocationCounter(state, allocations, runs);
+}
+BENCHMARK(BM_SimulatorRun)
+    ->Arg(static_cast<int>(Simulator::Integrator::SemiImplicitEuler))
+    ->Arg(static_cast<int>(Simulator::Integrator::DormandPrince))
+    ->Unit(benchmark::kMillisecond);
+
+// The first minute of the main.cpp vehicle under DormandPrince, advanced by
+// step(dt) with argument = dt in ms. Fails unless it takes the substeps of
+// runUntil(), which steps by maxStep() without interval boundaries, and ends
+// where it does.
+static void BM_AdaptiveStepInterval(benchmark::State &state)
+{
+    Optimizer &optimizer = mainScenarioOptimizer();
+    double dt = static_cast<double>(state.range(0)) / 1000.0;
+    constexpr double DURATION = 60.0; // s
+
+    auto reference = optimizer.createOptimizedSimulator();
+    reference->setIntegrator(Simulator::Integrator::DormandPrince);
+    reference->runUntil(config::TIME_STEP, [&](const Simulator &simulator)
+                        { return simulator.time() >= DURATION; });
+
+    std::uint64_t steps = 0;
+    bool substepsDiffer = false;
+    double mismatch = 0.0;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto simulator = optimizer.createOptimizedSimulator();
+        simulator->setIntegrator(Simulator::Integrator::DormandPrince);
+        state.ResumeTiming();
+
+        while (simulator->time() + dt <= reference->time())
+        {
+            simulator->step(dt);
+        }
+        simulator->step(reference->time() - simulator->time());
+
+        steps += simulator->stepCount();
+        // Ending exactly on the interval boundaries may cost a few extra substeps
+        std::size_t expected = reference->stepCount();
+        substepsDiffer |= simulator->stepCount() < expected || simulator->stepCount() > expected + expected / 100;
+        mismatch = std::max(mismatch, (simulator->rocket().position() - reference->rocket().position()).length());
+    }
+
+    state.counters["substeps_per_run"] = benchmark::Counter(static_cast<double>(steps) /
+                                                            static_cast<double>(state.iterations()));
+    state.counters["mismatch_m"] = benchmark::Counter(mismatch);
+    if (substepsDiffer || mismatch > 1e-3)
+    {
+        failCheck(state, "step(dt) and runUntil() disagree");
+    }
+}
+BENCHMARK(BM_AdaptiveStepInterval)->Arg(100)->Arg(1000)->Arg(5000)->Unit(benchmark::kMillisecond);
+
+// Fixed-step run of the main.cpp vehicle through Simulator, whose autopilot calls
+// go through the Autopilot interface (argument 0), and through GravityTurnSimulator,
+// compiled for GravityTurnAutopilot (argument 1)
+static void BM_SimulatorDispatch(benchmark::State &state)
+{
+    Optimizer &optimizer = mainScenarioOptimizer();
+    auto bestRocket = optimizer.getBestRocket();
+    auto bestAutopilot = optimizer.getBestAutopilot();
+    bool dynamic = state.range(0) == 0;
+    auto env = std::make_shared<Environment>();
+
+    std::uint64_t steps = 0;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto rocket = std::make_shared<Rocket>(*bestRocket);
+        auto autopilot = std::make_shared<GravityTurnAutopilot>(*bestAutopilot);
+        state.ResumeTiming();
+
+        if (dynamic)
+        {
+            Simulator simulator(rocket, env, DESTINATION, autopilot);
+            simulator.run();
+            steps += simulator.stepCount();
+        }
+        else
+        {
+            GravityTurnSimulator simulator(*rocket, *env, DESTINATION, autopilot.get());
+            simulator.run();
+            steps += simulator.stepCount();
+        }
+        benchmark::DoNotOptimize(rocket->position());
+    }
+
+    state.counters["steps_per_second"] = benchmark::Counter(static_cast<double>(steps), benchmark::Counter::kIsRate);
+    state.counters["time_per_step"] = benchmark::Counter(static_cast<double>(steps),
+                                                         benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+BENCHMARK(BM_SimulatorDispatch)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+// Optimizer::evaluate of the main.cpp best candidate, argument = PruningMode.
+// Fails unless the evaluation makes no heap allocation at all.
+static void BM_EvaluateCandidate(benchmark::State &state)
+{
+    Optimizer &optimizer = mainScenarioOptimizer();
+    PruningMode previous = optimizer.pruning();
+    optimizer.setPruning(static_cast<PruningMode>(state.range(0)));
+    Optimizer::OptimizedParameters params = optimizer.getOptimizedParameters();
+
+    std::uint64_t allocations = 0;
+    for (auto _ : state)
+    {
+        std::uint64_t before = allocationCount.load(std::memory_order_relaxed);
+        benchmark::DoNotOptimize(optimizer.evaluate(params));
+        allocations += allocationCount.load(std::memory_order_relaxed) - before;
+    }
+    optimizer.setPruning(previous);
+
+    setAllocationCounter(state, allocations, static_cast<double>(state.iterations()));
+    if (allocations != 0)
+    {
+        failCheck(state, "candidate evaluation allocated on the heap");
+    }
+}
+BENCHMARK(BM_EvaluateCandidate)
+    ->Arg(static_cast<int>(PruningMode::Off))
+    ->Arg(static_cast<int>(PruningMode::Aggressive))
+    ->Unit(benchmark::kMillisecond);
+
+// Optimizer::optimize on the main.cpp scenario at a fixed seed, arguments =
+// thread count (0 = all), batch simulation on/off
+static void BM_Optimize(benchmark::State &state)
+{
+    std::uint64_t evaluations = 0, allocations = 0;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        Optimizer optimizer(std::make_shared<Environment>(), DESTINATION, Optimizer::DEFAULT_SEED);
+        optimizer.setThreadCount(static_cast<unsigned>(state.range(0)));
+        optimizer.setBatchSimulation(state.range(1) != 0);
+        std::uint64_t before = allocationCount.load(std::memory_order_relaxed);
+        state.ResumeTiming();
+
+        optimizer.optimize(OPTIMIZER_ITERATIONS);
+
+        allocations += allocationCount.load(std::memory_order_relaxed) - before;
+        evaluations += optimizer.evaluationCount();
+        benchmark::DoNotOptimize(optimizer.getBestScore());
+    }
+
+    state.counters["evaluations_per_second"] = benchmark::Counter(static_cast<double>(evaluations),
+                                                                  benchmark::Counter::kIsRate);
+    setAllocationCounter(state, allocations, static_cast<double>(state.iterations()));
+}
+BENCHMARK(BM_Optimize)
+    ->Args({1, 0})
+    ->Args({1, 1})
+    ->Args({0, 1})
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+int main(int argc, char **argv)
+{
+    Logger::setLevel(LogLevel::None);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    if (checkFailed)
+    {
+        std::cerr << "rocket_sim_bench: a benchmark check failed\n";
+        return 1;
+    }
+    return 0;
+}
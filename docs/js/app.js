@@ -33,10 +33,19 @@ window.setStatusWindowVisibility = (visible) => {
 const OptimizerWorker = new Worker(new URL('./optimizer.worker.js', import.meta.url), {
   type: 'module'
 });
+// Wall-clock time the optimizer gets per destination; the best trajectory found
+// by then is flown
+const OPTIMIZATION_BUDGET_MS = 2000;
 
 const PHYSICS_TIME_STEP = 0.01;
 const RENDER_STEP = .2;
-let accumulatedTime = 0;
+// Physics steps per rendered frame; the simulator takes them in one stepMany() call
+const STEPS_PER_FRAME = Math.round(RENDER_STEP / PHYSICS_TIME_STEP);
+let timeWarp = 1;
+
+window.setTimeWarp = (factor) => {
+  timeWarp = Math.max(1, Math.round(factor));
+};
 
 const container = document.getElementById("scene-container");
 const scene = new THREE.Scene();
@@ -66,12 +75,85 @@ window.toggleAxes = (visible) => {
     scene.remove(axesHelper);
   }
 };
-let trajectoryPoints = [];
+// Grown by doubling; each frame only appends and widens the draw range
+let trajectoryPositions = new Float32Array(3 * 4096);
+let trajectoryCount = 0;
 const trajectoryGeometry = new THREE.BufferGeometry();
+trajectoryGeometry.setAttribute('position', new THREE.BufferAttribute(trajectoryPositions, 3));
+trajectoryGeometry.setDrawRange(0, 0);
 const trajectoryMaterial = new THREE.LineBasicMaterial({ color: 0x00ff00 });
 const trajectoryLine = new THREE.Line(trajectoryGeometry, trajectoryMaterial);
+trajectoryLine.frustumCulled = false;
 scene.add(trajectoryLine);
 
+function appendTrajectoryPoint(x, y, z) {
+  if (3 * (trajectoryCount + 1) > trajectoryPositions.length) {
+    const grown = new Float32Array(trajectoryPositions.length * 2);
+    grown.set(trajectoryPositions);
+    trajectoryPositions = grown;
+    trajectoryGeometry.setAttribute('position', new THREE.BufferAttribute(trajectoryPositions, 3));
+  }
+  trajectoryPositions[3 * trajectoryCount] = x;
+  trajectoryPositions[3 * trajectoryCount + 1] = y;
+  trajectoryPositions[3 * trajectoryCount + 2] = z;
+  ++trajectoryCount;
+}
+
+function clearTrajectory() {
+  trajectoryCount = 0;
+  trajectoryGeometry.setDrawRange(0, 0);
+}
+
+// Stands in for Module.TerminationReason on a module built before stepMany()
+const LEGACY_TERMINATION_REASON = Object.freeze({ None: 0, OutOfFuel: 1, Arrived: 2 });
+
+function terminationReasons() {
+  return Module.TerminationReason ?? LEGACY_TERMINATION_REASON;
+}
+
+// The steps of a frame in one call into WASM, with one sample per STEPS_PER_FRAME
+// steps read straight from the WASM heap. Returns the visual positions of the
+// samples, `stride` floats apart, and why the run ended, if it did.
+function stepFrame(simulator, steps) {
+  simulator.stepMany(steps, STEPS_PER_FRAME, PHYSICS_TIME_STEP);
+  const samples = simulator.samples();
+  const stride = Module.VISUAL_SAMPLE_FLOATS;
+  return {
+    positions: samples.subarray(1), // after the sample time
+    stride,
+    count: samples.length / stride,
+    reason: simulator.terminationReason()
+  };
+}
+
+// stepFrame() for a module built before stepMany(): one step() call per step,
+// with the out-of-fuel and arrival checks made every STEPS_PER_FRAME steps
+function stepFrameLegacy(simulator, steps) {
+  const reasons = LEGACY_TERMINATION_REASON;
+  const positions = [];
+  let reason = reasons.None;
+  for (let taken = 0; taken < steps; taken += STEPS_PER_FRAME) {
+    const rocket = simulator.rocket();
+    const outOfFuel = rocket.isOutOfFuel();
+    rocket.delete();
+    // Its isArrived() takes the tolerance, which Simulator::ARRIVAL_TOLERANCE now fixes
+    if (outOfFuel || simulator.isArrived(1500)) {
+      reason = outOfFuel ? reasons.OutOfFuel : reasons.Arrived;
+      break;
+    }
+
+    for (let i = 0; i < STEPS_PER_FRAME; ++i) {
+      simulator.step(PHYSICS_TIME_STEP);
+    }
+    const state = simulator.getVisualState();
+    positions.push(state.position.x, state.position.y, state.position.z);
+    state.position.delete();
+    state.velocity.delete();
+    state.thrustDirection.delete();
+  }
+  return { positions, stride: 3, count: positions.length / 3, reason };
+}
+
 window.addEventListener("resize", () => {
   camera.aspect = window.innerWidth / window.innerHeight;
   camera.updateProjectionMatrix();
@@ -427,10 +509,14 @@ async function initSimulation() {
           OptimizerWorker.postMessage({
             type: 'optimize',
             destination: fixedDestination,
-            iterations: 40
+            budgetMs: OPTIMIZATION_BUDGET_MS
           });
           break;
 
+        case 'optimization_progress':
+          console.log(`Optimizing: ${e.data.evaluations} evaluations, best score ${e.data.bestScore.toFixed(0)}`);
+          break;
+
         case 'optimization_complete':
           console.log("Optimization complete", e.data);
           hideOptimizationLoader();
@@ -528,8 +614,7 @@ window.resetSimulation = function () {
 
   targetPosition = null;
 
-  trajectoryPoints.length = 0;
-  trajectoryGeometry.setAttribute('position', new THREE.BufferAttribute(new Float32Array(0), 3));
+  clearTrajectory();
 
   const distanceText = document.getElementById('arrival-distance-text');
   if (distanceText) distanceText.remove();
@@ -592,18 +677,23 @@ function startVisualizationLoop() {
   function updateVisualization() {
     if (!window.simulator || simulationEnded) return;
 
-    const visualState = window.simulator.getVisualState();
-    const visualPosition = new THREE.Vector3(
-      visualState.position.x,
-      visualState.position.y - 693,
-      visualState.position.z
-    );
-    rocket.position.copy(visualPosition);
+    const steps = STEPS_PER_FRAME * timeWarp;
+    const { positions, stride, count, reason } = typeof window.simulator.stepMany === 'function'
+      ? stepFrame(window.simulator, steps)
+      : stepFrameLegacy(window.simulator, steps);
 
-    trajectoryPoints.push(visualPosition.clone());
-    trajectoryGeometry.setFromPoints(trajectoryPoints);
+    for (let i = 0; i < count; ++i) {
+      const offset = i * stride;
+      appendTrajectoryPoint(positions[offset], positions[offset + 1] - 693, positions[offset + 2]);
+    }
+    if (count > 0) {
+      const last = (count - 1) * stride;
+      rocket.position.set(positions[last], positions[last + 1] - 693, positions[last + 2]);
+      trajectoryGeometry.attributes.position.needsUpdate = true;
+      trajectoryGeometry.setDrawRange(0, trajectoryCount);
+    }
 
-    const hasArrived = checkAndVisualizeArrival(rocket.position, 1500);
+    const hasArrived = checkAndVisualizeArrival(rocket.position, reason);
 
     if (statusWindow && statusWindow.style.display !== 'none') {
       try {
@@ -624,15 +714,10 @@ function startVisualizationLoop() {
       }
     }
 
-    if (!window.simulator.rocket().isOutOfFuel() && !hasArrived) {
-      accumulatedTime += RENDER_STEP;
-      while (accumulatedTime >= PHYSICS_TIME_STEP) {
-        window.simulator.step(PHYSICS_TIME_STEP);
-        accumulatedTime -= PHYSICS_TIME_STEP;
-      }
-    } else {
+    if (reason !== terminationReasons().None) {
       simulationEnded = true;
-      if (window.simulator.rocket().isOutOfFuel()) {
+      const outOfFuel = reason === terminationReasons().OutOfFuel;
+      if (outOfFuel) {
         const fuelExhaustMarker = new THREE.Mesh(
           new THREE.SphereGeometry(0.02, 16, 16),
           new THREE.MeshBasicMaterial({ color: 0xffff00 })
@@ -641,7 +726,7 @@ function startVisualizationLoop() {
         scene.add(fuelExhaustMarker);
       }
       console.log("Simulation ended - " +
-        (window.simulator.rocket().isOutOfFuel() ? "Fuel exhausted" : "Destination reached"));
+        (outOfFuel ? "Fuel exhausted" : hasArrived ? "Destination reached" : "Time limit reached"));
     }
   }
 
@@ -661,10 +746,10 @@ function startVisualizationLoop() {
   visualizationAnimation();
 }
 
-function checkAndVisualizeArrival(rocketPos) {
+function checkAndVisualizeArrival(rocketPos, reason) {
   if (!window.simulator) return false;
 
-  const hasArrived = window.simulator.isArrived(1500);
+  const hasArrived = reason === terminationReasons().Arrived;
 
   if (hasArrived && !scene.getObjectByName("arrivalMarker")) {
     const marker = new THREE.Mesh(
@@ -1,11 +1,31 @@
 let Module;
 
-import createRocketSimModule from '../wasm/rocket_sim.js';
+// The pthreads build needs SharedArrayBuffer, which browsers only hand to
+// cross-origin isolated pages (COOP/COEP headers); anywhere else, or if it was
+// not built, the single-threaded build is loaded
+async function loadModule() {
+    if (typeof SharedArrayBuffer !== 'undefined' && self.crossOriginIsolated) {
+        try {
+            const { default: createRocketSimModule } = await import('../wasm/rocket_sim_threads.js');
+            return await createRocketSimModule();
+        } catch (error) {
+            console.warn('Threaded WebAssembly build unavailable, optimizing on one thread:', error);
+        }
+    }
+    const { default: createRocketSimModule } = await import('../wasm/rocket_sim.js');
+    return createRocketSimModule();
+}
 
 async function initialize() {
     try {
-        Module = await createRocketSimModule();
-        self.postMessage({ type: 'initialized' });
+        // Loaded once; starting the thread pool again for every destination would
+        // cost more than the optimization saves
+        if (!Module) {
+            Module = await loadModule();
+        }
+        // A module built before the threading bindings has neither function
+        const threaded = typeof Module.threadsSupported === 'function' && Module.threadsSupported();
+        self.postMessage({ type: 'initialized', threaded });
     } catch (error) {
         self.postMessage({
             type: 'error',
@@ -17,19 +37,39 @@ async function initialize() {
 
 
 
-function runOptimization(destination, iterations = 50) {
+// With a time budget the search reports its best score after every batch and
+// stops at the deadline; otherwise it spends a fixed number of evaluations
+function runOptimization(destination, iterations = 50, budgetMs = 0) {
     try {
         const env = Module.createEnvironment();
         const physicsDestination = new Module.Vector3(destination.x, destination.y, destination.z);
         const optimizer = Module.createOptimizer(physicsDestination);
 
-        optimizer.optimize(iterations);
+        // Every core in the threaded build, one otherwise
+        const threadControl = typeof optimizer.setThreadCount === 'function';
+        if (threadControl) {
+            optimizer.setThreadCount(0);
+        }
+        // A module built before the anytime API only has the fixed-count search
+        if (budgetMs > 0 && typeof optimizer.optimizeFor === 'function') {
+            optimizer.optimizeFor(budgetMs, (progress) => {
+                self.postMessage({
+                    type: 'optimization_progress',
+                    evaluations: progress.evaluations,
+                    elapsedSeconds: progress.elapsedSeconds,
+                    bestScore: progress.bestScore
+                });
+            });
+        } else {
+            optimizer.optimize(iterations);
+        }
 
         const bestRocket = optimizer.getBestRocket();
         const bestAutopilot = optimizer.getBestAutopilot();
 
         const result = {
             type: 'optimization_complete',
+            threads: threadControl ? optimizer.threadCount() : 1,
             rocketParams: {
                 dryMass: bestRocket.dryMass(),
                 fuelMass: bestRocket.fuelMass(),
@@ -62,6 +102,53 @@ function runOptimization(destination, iterations = 50) {
     }
 }
 
+// Module.optimizeDestinations for a module built before it: the destinations one
+// after the other, each with its own Optimizer, in the record format of
+// Optimizer::toJson
+function optimizeDestinationsOneByOne(destinations, iterations) {
+    return destinations.map((destination) => {
+        const physicsDestination = new Module.Vector3(destination.x, destination.y, destination.z);
+        const optimizer = Module.createOptimizer(physicsDestination);
+        optimizer.optimize(iterations);
+
+        const bestRocket = optimizer.getBestRocket();
+        const bestAutopilot = optimizer.getBestAutopilot();
+        const record = {
+            dryMass: bestRocket.dryMass(),
+            initialFuel: bestRocket.fuelMass(),
+            burnRate: bestRocket.burnRate(),
+            specificImpulse: bestRocket.specificImpulse(),
+            turnStartAltitude: bestAutopilot.turnStartAltitude(),
+            turnRate: bestAutopilot.turnRate()
+        };
+
+        bestAutopilot.delete();
+        bestRocket.delete();
+        optimizer.delete();
+        physicsDestination.delete();
+        return record;
+    });
+}
+
+// One record per destination, in order; all of them share the worker's threads
+function runBatchOptimization(destinations, iterations = 50) {
+    try {
+        const results = typeof Module.optimizeDestinations === 'function'
+            ? Module.optimizeDestinations(destinations, iterations).map((record) => JSON.parse(record))
+            : optimizeDestinationsOneByOne(destinations, iterations);
+        self.postMessage({
+            type: 'batch_optimization_complete',
+            results
+        });
+    } catch (error) {
+        self.postMessage({
+            type: 'error',
+            message: 'Batch optimization failed',
+            error: error.toString()
+        });
+    }
+}
+
 self.onmessage = async (e) => {
     switch (e.data.type) {
         case 'init':
@@ -76,7 +163,18 @@ self.onmessage = async (e) => {
                 });
                 return;
             }
-            runOptimization(e.data.destination, e.data.iterations);
+            runOptimization(e.data.destination, e.data.iterations, e.data.budgetMs);
+            break;
+
+        case 'optimize_batch':
+            if (!Module) {
+                self.postMessage({
+                    type: 'error',
+                    message: 'WASM not initialized'
+                });
+                return;
+            }
+            runBatchOptimization(e.data.destinations, e.data.iterations);
             break;
     }
 };
\ No newline at end of file
@@ -0,0 +1,42 @@
+// Runs the optimizer of the WebAssembly build under Node and reports how long it took,
+// to check the threaded build without a browser:
+//
+//   node scripts/optimize-node.mjs [iterations] [threads]
+//
+// threads = 0 (the default) uses every core. The pthreads build (wasm/rocket_sim_threads.js)
+// is used when it exists, otherwise the single-threaded one.
+import { existsSync } from 'node:fs';
+import { fileURLToPath } from 'node:url';
+
+const iterations = Number(process.argv[2] ?? 200);
+const threads = Number(process.argv[3] ?? 0);
+
+const threadedBuild = new URL('../wasm/rocket_sim_threads.js', import.meta.url);
+const build = existsSync(fileURLToPath(threadedBuild))
+    ? threadedBuild
+    : new URL('../wasm/rocket_sim.js', import.meta.url);
+
+const { default: createRocketSimModule } = await import(build.href);
+const Module = await createRocketSimModule();
+
+// The scenario of main.cpp
+const destination = new Module.Vector3(90000, 100000 + Module.EARTH_RADIUS, 40000);
+const optimizer = Module.createOptimizer(destination);
+// Missing from a module built before the threading bindings, which runs on one thread
+const threadControl = typeof optimizer.setThreadCount === 'function';
+if (threadControl) {
+    optimizer.setThreadCount(threads);
+}
+
+const start = performance.now();
+optimizer.optimize(iterations);
+const seconds = (performance.now() - start) / 1000;
+
+console.log(`${build.pathname.split('/').pop()}: ${iterations} evaluations on ${threadControl ? optimizer.threadCount() : 1} ` +
+    `thread(s) in ${seconds.toFixed(2)} s (${(iterations / seconds).toFixed(1)}/s)`);
+
+optimizer.delete();
+destination.delete();
+
+// The pthread pool keeps the event loop alive
+process.exit(0);
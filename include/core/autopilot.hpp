@@ -3,6 +3,7 @@
 #include "rocket.hpp"
 #include "vector3.hpp"
 #include "environment.hpp"
+#include "step_context.hpp"
 #include <cmath>
 #include <memory>
 
@@ -14,9 +15,32 @@ namespace sim::core
     public:
         virtual ~Autopilot() = default;
         virtual void update(Rocket &rocket, const Vector3 &totalForce, double time, double dt) = 0;
+
+        // Called by Simulator with the kinematics it already computed for the step
+        virtual void update(Rocket &rocket, const StepContext & /*context*/,
+                            const Vector3 &totalForce, double time, double dt)
+        {
+            update(rocket, totalForce, time, dt);
+        }
+
+        // Lowest thrust level commanded while fuel remains; lets the simulator bound
+        // how long a run can still last. 0 means no guarantee.
+        virtual double minimumThrustLevel() const { return 0.0; }
+
+        // True once guidance has committed to the final approach
+        virtual bool isTerminalPhase() const { return false; }
+
+        // Index of the current guidance phase, for trajectory records
+        virtual int phase() const { return 0; }
+
+        // Copy in the same guidance state, for Simulator snapshots; nullptr if the
+        // autopilot cannot be copied
+        virtual std::shared_ptr<Autopilot> clone() const { return nullptr; }
     };
 
-    class GravityTurnAutopilot : public Autopilot
+    // Final, so calls through a GravityTurnAutopilot (BasicSimulator, BatchSimulator)
+    // are direct and the ones defined here inline
+    class GravityTurnAutopilot final : public Autopilot
     {
     public:
         enum class Phase
@@ -38,6 +62,9 @@ namespace sim::core
         Phase phase_ = Phase::VerticalAscent;
         std::shared_ptr<Environment> environment_;
 
+        // The vertical ascent ends once this altitude is reached
+        double turnDecisionAltitude() const { return targetAltitude_ * 0.5; }
+
     public:
         GravityTurnAutopilot(double targetAltitude,
                              const Vector3 &destination,
@@ -49,14 +76,31 @@ namespace sim::core
         virtual ~GravityTurnAutopilot() = default;
 
         void update(Rocket &rocket, const Vector3 &totalForce, double time, double dt) override;
+        void update(Rocket &rocket, const StepContext &context,
+                    const Vector3 &totalForce, double time, double dt) override;
+
+        // Every phase burns at full thrust until the fuel is gone
+        double minimumThrustLevel() const override { return 1.0; }
+        bool isTerminalPhase() const override { return phase_ == Phase::TargetApproach; }
+        int phase() const override { return static_cast<int>(phase_); }
+        std::shared_ptr<Autopilot> clone() const override;
+
+        // Copy in the same guidance state that flies the turn with other parameters
+        GravityTurnAutopilot withTurn(double turnStartAltitude, double turnRate) const;
+
+        // Until this holds for the rocket about to be stepped, guidance has only flown
+        // straight up and has not used turnStartAltitude or turnRate
+        bool isVerticalAscentOver(const Rocket &rocket) const;
 
         Vector3 calculateOptimalTurnDirection(const Rocket &rocket, const Vector3 &totalForce) const;
+        Vector3 calculateOptimalTurnDirection(const StepContext &context, const Vector3 &totalForce) const;
         Vector3 calculateStopDistance(const Rocket &rocket, const Vector3 &totalForce) const;
 
         double turnStartAltitude() const;
         double turnRate() const;
         double targetAltitude() const;
         double maxAngularVelocity() const;
+        const Vector3 &destination() const { return destination_; }
 
         void setTurnRate(double rate) { turnRate_ = rate * 0.5; }
         void setMaxAngularVelocity(double vel) { maxAngularVelocity_ = vel * 0.8; }
@@ -0,0 +1,880 @@
+#pragma once
+
+#include "rocket.hpp"
+#include "environment.hpp"
+#include "autopilot.hpp"
+#include "trajectory_recorder.hpp"
+#include "metrics.hpp"
+#include "step_context.hpp"
+#include "../physics/kepler.hpp"
+#include "../utils/config.hpp"
+#include "../utils/logger.hpp"
+#include "vector3.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace sim::core
+{
+
+    // Lower bound on the distance to a fixed point at any later time of a run that
+    // ends when the fuel is gone, from the remaining delta-v. Zero if the thrust level
+    // may drop to zero (minThrustLevel <= 0), since then no end time is known.
+    double distanceLowerBound(double distance, double speed,
+                              double fuelMass, double totalMass,
+                              double burnRate, double exhaustVelocity,
+                              double minThrustLevel, double timeLeft, double dt);
+
+    // Settings and progress of a run, shared by every BasicSimulator whatever it flies
+    class SimulatorBase
+    {
+    public:
+        enum class TerminationReason
+        {
+            None,
+            OutOfFuel,
+            Arrived,
+            TimeLimit,
+            Pruned,
+            GroundContact,  // fell back to the surface after burnout
+            ClosestApproach // coasting above the atmosphere, will never get closer
+        };
+
+        enum class Integrator
+        {
+            SemiImplicitEuler, // fixed step, the default
+            DormandPrince      // embedded RK5(4) with error control
+        };
+
+        static constexpr double MAX_SIMULATION_TIME = 36000000000.0; // s
+        static constexpr std::size_t PRUNING_CHECK_INTERVAL = 64;     // steps
+        static constexpr std::size_t RECEDING_STEPS_TO_PRUNE = 50;
+        static constexpr double ARRIVAL_TOLERANCE = 1500.0; // m
+
+        static constexpr double DEFAULT_ABSOLUTE_TOLERANCE = 1e-3; // m, m/s, kg
+        static constexpr double DEFAULT_RELATIVE_TOLERANCE = 1e-9;
+        static constexpr double DEFAULT_MAX_STEP = 0.1;            // s
+        static constexpr double MIN_ADAPTIVE_STEP = 1e-6;          // s
+
+        // Everything a run changes: the rocket and the autopilot by value, and the
+        // progress of the run itself. Settings such as the integrator or the pruning
+        // bound belong to the simulator and are not part of it.
+        struct Snapshot
+        {
+            Rocket rocket;
+            std::shared_ptr<const Autopilot> autopilot; // a clone, never stepped
+            double time = 0.0;
+            std::size_t stepCount = 0;
+            double nextStep = 0.0;
+            double minDistance = std::numeric_limits<double>::max();
+            bool wasClose = false;
+            std::size_t recedingSteps = 0;
+            double lastDistance = std::numeric_limits<double>::max();
+            bool atAtmosphereEdge = false;
+            double pruningPeak = -std::numeric_limits<double>::infinity();
+        };
+
+    protected:
+        Vector3 destination_;
+        double minDistance_ = std::numeric_limits<double>::max();
+        bool wasClose_ = false;
+        double time_ = 0.0;
+
+        double pruningBound_ = std::numeric_limits<double>::infinity();
+        bool recedingPruning_ = false;
+        double prunedAt_ = 0.0;
+        TerminationReason terminationReason_ = TerminationReason::None;
+
+        Integrator integrator_ = Integrator::SemiImplicitEuler;
+        double absoluteTolerance_ = DEFAULT_ABSOLUTE_TOLERANCE;
+        double relativeTolerance_ = DEFAULT_RELATIVE_TOLERANCE;
+        double maxStep_ = DEFAULT_MAX_STEP;
+        double timeStep_ = sim::utils::config::TIME_STEP;
+        double nextStep_ = 0.0;
+        std::size_t stepCount_ = 0;
+
+        // State of the termination checks in run(), kept across runUntil() pauses
+        std::size_t recedingSteps_ = 0;
+        double lastDistance_ = std::numeric_limits<double>::max();
+        bool atAtmosphereEdge_ = false;
+        double pruningPeak_ = -std::numeric_limits<double>::infinity();
+
+        bool coastAfterBurnout_ = false;
+
+        std::shared_ptr<TrajectoryRecorder> recorder_;
+
+        bool metricsEnabled_ = false;
+        SimulationMetrics metrics_;
+
+        explicit SimulatorBase(const Vector3 &destination);
+
+        // Progress part of a snapshot; the rocket and autopilot are the caller's
+        void restoreCounters(const Snapshot &snapshot);
+
+        // Splits the wall time of a step between the fields of SimulationMetrics;
+        // does nothing without metrics
+        class StepTimer
+        {
+        private:
+            using Clock = std::chrono::steady_clock;
+
+            SimulationMetrics *metrics_;
+            Clock::time_point start_, last_;
+
+        public:
+            explicit StepTimer(SimulationMetrics *metrics) : metrics_(metrics)
+            {
+                if (metrics_)
+                {
+                    start_ = last_ = Clock::now();
+                }
+            }
+
+            // Adds the time since the previous lap to `field`
+            void lap(std::uint64_t SimulationMetrics::*field)
+            {
+                if (metrics_)
+                {
+                    Clock::time_point now = Clock::now();
+                    metrics_->*field += std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_).count();
+                    last_ = now;
+                }
+            }
+
+            // Books the whole step under the autopilot phase
+            void finish(int phase, double dt)
+            {
+                if (metrics_)
+                {
+                    std::size_t index = std::min<std::size_t>(std::max(phase, 0), SimulationMetrics::MAX_PHASES - 1);
+                    SimulationMetrics::Phase &p = metrics_->phases[index];
+                    ++metrics_->steps;
+                    ++p.steps;
+                    p.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(last_ - start_).count();
+                    p.simulatedSeconds += dt;
+                }
+            }
+        };
+
+        struct FlightState
+        {
+            Vector3 position;
+            Vector3 velocity;
+            double fuelMass;
+        };
+
+        // Dormand-Prince 5(4) tableau
+        static constexpr double A21 = 1.0 / 5.0;
+        static constexpr double A31 = 3.0 / 40.0, A32 = 9.0 / 40.0;
+        static constexpr double A41 = 44.0 / 45.0, A42 = -56.0 / 15.0, A43 = 32.0 / 9.0;
+        static constexpr double A51 = 19372.0 / 6561.0, A52 = -25360.0 / 2187.0, A53 = 64448.0 / 6561.0,
+                                A54 = -212.0 / 729.0;
+        static constexpr double A61 = 9017.0 / 3168.0, A62 = -355.0 / 33.0, A63 = 46732.0 / 5247.0,
+                                A64 = 49.0 / 176.0, A65 = -5103.0 / 18656.0;
+        static constexpr double B1 = 35.0 / 384.0, B3 = 500.0 / 1113.0, B4 = 125.0 / 192.0,
+                                B5 = -2187.0 / 6784.0, B6 = 11.0 / 84.0;
+        // Fifth minus fourth order weights
+        static constexpr double E1 = 71.0 / 57600.0, E3 = -71.0 / 16695.0, E4 = 71.0 / 1920.0,
+                                E5 = -17253.0 / 339200.0, E6 = 22.0 / 525.0, E7 = -1.0 / 40.0;
+
+        static constexpr double SAFETY = 0.9;
+        static constexpr double MIN_SCALE = 0.2;
+        static constexpr double MAX_SCALE = 5.0;
+        // Fraction of the remaining distance one step may cover, so the closest
+        // approach is sampled finely enough for the arrival check
+        static constexpr double APPROACH_FRACTION = 0.25;
+
+        static FlightState combine(const FlightState &y, double h,
+                                   std::initializer_list<std::pair<double, const FlightState *>> terms)
+        {
+            FlightState result = y;
+            for (const auto &[weight, k] : terms)
+            {
+                result.position += k->position * (h * weight);
+                result.velocity += k->velocity * (h * weight);
+                result.fuelMass += k->fuelMass * (h * weight);
+            }
+            return result;
+        }
+
+        static double scaledError(double error, double before, double after, double atol, double rtol)
+        {
+            double scale = atol + rtol * std::max(std::abs(before), std::abs(after));
+            double e = error / scale;
+            return e * e;
+        }
+
+    public:
+        // The autopilot is consulted once per step and the thrust it sets is held
+        // constant over the step. Steps end exactly at burnout.
+        void setIntegrator(Integrator integrator);
+        Integrator integrator() const;
+        void setTolerances(double absolute, double relative);
+        void setMaxStep(double maxStep);
+        double maxStep() const;
+        // Step size of run() without an argument; config::TIME_STEP by default
+        void setTimeStep(double dt);
+        double timeStep() const;
+
+        // Steps taken since construction or reset()
+        std::size_t stepCount() const;
+
+        // Keep flying after the fuel is gone instead of stopping. Above the atmosphere
+        // the unpowered flight is propagated analytically, straight to the closest
+        // approach and then to re-entry; in the atmosphere it is stepped until the
+        // rocket reaches the destination or the ground. The distance pruning bound
+        // assumes runs end at burnout, so it is not applied in this mode.
+        void setCoastAfterBurnout(bool enabled);
+        bool coastAfterBurnout() const;
+
+        // Sends the state after every step (and the start and end of run()) to the
+        // recorder, which decides what to keep. nullptr detaches it.
+        void setRecorder(std::shared_ptr<TrajectoryRecorder> recorder);
+        const std::shared_ptr<TrajectoryRecorder> &recorder() const;
+
+        // Off by default; while off, each step pays one branch for it
+        void setMetricsEnabled(bool enabled);
+        bool metricsEnabled() const;
+        const SimulationMetrics &metrics() const;
+        void resetMetrics();
+
+        // Smallest distance to the destination seen so far
+        double closestApproach() const;
+
+        void setDestination(const Vector3 &destination);
+        void updateMinDistance(const double newMinDist);
+        const Vector3 &destination() const;
+
+        // run() gives up as soon as minimumAchievableDistance() exceeds the bound.
+        // Pass infinity (the default) to disable pruning.
+        void setPruningBound(double bound);
+        double pruningBound() const;
+
+        // Heuristic on top of the bound: also stop once the autopilot is in its terminal
+        // phase and the rocket has been moving away from the destination for
+        // RECEDING_STEPS_TO_PRUNE steps while farther away than the bound
+        void setRecedingPruning(bool enabled);
+
+        // Distance estimate that triggered pruning; the final score of the run would
+        // not have been lower
+        double prunedDistance() const;
+
+        // Largest distance estimate the pruning checks of run() let pass. The run ends
+        // the same way under any bound at or above it (and below prunedDistance() if
+        // it was pruned), and is pruned earlier under any bound below it. Infinity if
+        // it ran without a bound, so that nothing is known; -infinity if no check ran.
+        double pruningPeak() const;
+
+        TerminationReason terminationReason() const;
+
+        double time() const;
+    };
+
+    // The flight loop, compiled for one rocket, autopilot and environment type. With
+    // concrete types (GravityTurnSimulator below) every call of the step loop is
+    // direct and the compiler can inline through it; Simulator flies the same loop
+    // through the Autopilot interface for callers that pick the autopilot at runtime.
+    //
+    // RocketT is Rocket or derived from it, AutopilotT has the interface of Autopilot
+    // and EnvironmentT that of Environment. The simulator holds all three by pointer
+    // and owns none of them; they must outlive it. Copies share them.
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    class BasicSimulator : public SimulatorBase
+    {
+    protected:
+        RocketT *rocket_;
+        EnvironmentT *environment_;
+        AutopilotT *autopilot_; // null flies without guidance
+
+        void recordState(bool force = false);
+
+        // restore() without the autopilot
+        void restoreProgress(const Snapshot &snapshot);
+
+        // Whether the autopilot is consulted before the next step
+        bool isSteering() const;
+
+        // Jumps along the Kepler orbit to the next event; false if the trajectory
+        // has no orbital plane and has to be stepped
+        bool coast();
+        bool isOnGround() const;
+
+        // One error-controlled step of at most maxStep; returns the step size taken
+        double adaptiveStep(double minStep, double maxStep);
+
+    public:
+        // Places the rocket on the launch pad
+        BasicSimulator(RocketT &rocket, EnvironmentT &environment,
+                       const Vector3 &destination, AutopilotT *autopilot = nullptr);
+
+        Vector3 calculateTotalForce() const;
+        void updateRocketState(double dt, const Vector3 &acceleration);
+
+        // With DormandPrince, dt is the first step size tried and the smallest step
+        // used when approaching the destination; steps then grow up to maxStep().
+        void run(double dt);
+        void run(); // run(timeStep())
+        // Advances by exactly dt; DormandPrince takes as many substeps as it needs
+        void step(double dt);
+
+        // run() that returns false, between two steps, as soon as pause(*this)
+        // returns true; true once the run has ended. Calling it again resumes the
+        // run exactly where it left off.
+        template <typename Pause>
+        bool runUntil(double dt, Pause &&pause);
+
+        // Throws std::logic_error if the autopilot cannot be cloned
+        Snapshot snapshot() const;
+        // Rewinds to `snapshot`, continuing with `autopilot`, which should be in the
+        // guidance state of the saved one; the rocket keeps its identity. Allocates
+        // nothing.
+        void restore(const Snapshot &snapshot, AutopilotT *autopilot);
+
+        bool isArrived(double tolerance = ARRIVAL_TOLERANCE);
+        double getCurrentDistance() const;
+
+        // Lower bound on the distance to the destination at any later point of run(),
+        // from the remaining delta-v of the fuel on board. Zero if no bound is known.
+        double minimumAchievableDistance(double dt = sim::utils::config::TIME_STEP) const;
+
+        const RocketT &rocket() const;
+        const EnvironmentT &environment() const;
+
+        Rocket::RocketState getRocketState() const;
+        void reset();
+    };
+
+    // Flies the optimizer's vehicle with every call of the step loop resolved at
+    // compile time
+    using GravityTurnSimulator = BasicSimulator<Rocket, GravityTurnAutopilot, Environment>;
+
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    BasicSimulator<RocketT, AutopilotT, EnvironmentT>::BasicSimulator(RocketT &rocket, EnvironmentT &environment,
+                                                                      const Vector3 &destination,
+                                                                      AutopilotT *autopilot)
+        : SimulatorBase(destination),
+          rocket_(&rocket),
+          environment_(&environment),
+          autopilot_(autopilot)
+    {
+        rocket_->setPosition(Vector3(0, sim::utils::config::EARTH_RADIUS + 1.0, 0));
+    }
+
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    double BasicSimulator<RocketT, AutopilotT, EnvironmentT>::getCurrentDistance() const
+    {
+        return (rocket_->position() - destination_).length();
+    }
+
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    bool BasicSimulator<RocketT, AutopilotT, EnvironmentT>::isArrived(double tolerance)
+    {
+        double distance = getCurrentDistance();
+
+        if (distance < minDistance_)
+        {
+            minDistance_ = distance;
+        }
+
+        if (distance < 2.0 * tolerance)
+        {
+            wasClose_ = true;
+        }
+
+        return wasClose_ && (distance > minDistance_) && (minDistance_ <= tolerance);
+    }
+
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    const RocketT &BasicSimulator<RocketT, AutopilotT, EnvironmentT>::rocket() const
+    {
+        return *rocket_;
+    }
+
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    const EnvironmentT &BasicSimulator<RocketT, AutopilotT, EnvironmentT>::environment() const
+    {
+        return *environment_;
+    }
+
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    Vector3 BasicSimulator<RocketT, AutopilotT, EnvironmentT>::calculateTotalForce() const
+    {
+        Vector3 gForce = environment_->computeGravityForce(*rocket_);
+        Vector3 dragForce = environment_->computeDragForce(*rocket_);
+        Vector3 thrustForce = rocket_->thrust();
+
+        return gForce + dragForce + thrustForce;
+    }
+
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    void BasicSimulator<RocketT, AutopilotT, EnvironmentT>::updateRocketState(double dt, const Vector3 &acceleration)
+    {
+        rocket_->setVelocity(rocket_->velocity() + acceleration * dt);
+        rocket_->setPosition(rocket_->position() + rocket_->velocity() * dt);
+    }
+
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    bool BasicSimulator<RocketT, AutopilotT, EnvironmentT>::isSteering() const
+    {
+        // Nothing left to steer once a coasting rocket has burnt out
+        return autopilot_ && !(coastAfterBurnout_ && rocket_->isOutOfFuel());
+    }
+
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    void BasicSimulator<RocketT, AutopilotT, EnvironmentT>::step(double dt)
+    {
+        if (integrator_ == Integrator::DormandPrince)
+        {
+            double remaining = dt;
+            while (remaining > MIN_ADAPTIVE_STEP)
+            {
+                remaining -= adaptiveStep(std::min(dt, sim::utils::config::TIME_STEP), std::min(remaining, maxStep_));
+            }
+            return;
+        }
+
+        StepTimer timer(metricsEnabled_ ? &metrics_ : nullptr);
+
+        // Gravity and drag depend only on the state, which the autopilot leaves alone;
+        // only the thrust it commands has to be added again
+        StepContext context = environment_->prepareStep(*rocket_);
+        Vector3 passiveForce = environment_->computeGravityForce(context) +
+                               environment_->computeDragForce(context,
+                                                              rocket_->getDragCoefficient(),
+                                                              rocket_->getCrossSectionArea());
+        timer.lap(&SimulationMetrics::forceNanoseconds);
+
+        if (isSteering())
+        {
+            autopilot_->update(*rocket_, context, passiveForce + rocket_->thrust(), time_, dt);
+        }
+        timer.lap(&SimulationMetrics::autopilotNanoseconds);
+
+        rocket_->update(dt, passiveForce + rocket_->thrust());
+        timer.lap(&SimulationMetrics::integrationNanoseconds);
+        timer.finish(autopilot_ ? autopilot_->phase() : 0, dt);
+
+        time_ += dt;
+        ++stepCount_;
+        recordState();
+    }
+
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    void BasicSimulator<RocketT, AutopilotT, EnvironmentT>::run(double dt)
+    {
+        auto never = [](const BasicSimulator &)
+        { return false; };
+        runUntil(dt, never);
+    }
+
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    void BasicSimulator<RocketT, AutopilotT, EnvironmentT>::run()
+    {
+        run(timeStep_);
+    }
+
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    template <typename Pause>
+    bool BasicSimulator<RocketT, AutopilotT, EnvironmentT>::runUntil(double dt, Pause &&pause)
+    {
+        using sim::utils::Logger;
+
+        terminationReason_ = TerminationReason::None;
+        // Once coasting is allowed the fuel no longer bounds how long a run lasts
+        bool pruning = pruningBound_ < std::numeric_limits<double>::infinity() && !coastAfterBurnout_;
+        bool recedingCheck = pruning && recedingPruning_ && autopilot_;
+        if (!pruning && !coastAfterBurnout_)
+        {
+            pruningPeak_ = std::numeric_limits<double>::infinity();
+        }
+        recordState(true);
+
+        while (true)
+        {
+            // Before the checks, which are not idempotent, so a resumed run makes them once
+            if (pause(static_cast<const BasicSimulator &>(*this)))
+            {
+                return false;
+            }
+
+            if (time_ >= MAX_SIMULATION_TIME)
+            {
+                terminationReason_ = TerminationReason::TimeLimit;
+                break;
+            }
+            if (rocket_->isOutOfFuel())
+            {
+                if (!coastAfterBurnout_)
+                {
+                    terminationReason_ = TerminationReason::OutOfFuel;
+                    break;
+                }
+                if (isOnGround())
+                {
+                    terminationReason_ = TerminationReason::GroundContact;
+                    break;
+                }
+
+                double altitude = rocket_->position().length() - sim::utils::config::EARTH_RADIUS;
+                if (altitude <= sim::utils::config::ATMOSPHERE_HEIGHT)
+                {
+                    atAtmosphereEdge_ = false;
+                }
+                else if (!atAtmosphereEdge_ && coast())
+                {
+                    if (terminationReason_ != TerminationReason::None)
+                    {
+                        break;
+                    }
+                    // Left at the re-entry point; step from here
+                    atAtmosphereEdge_ = true;
+                    continue;
+                }
+            }
+            if (isArrived())
+            {
+                terminationReason_ = TerminationReason::Arrived;
+                break;
+            }
+
+            if (recedingCheck && autopilot_->isTerminalPhase())
+            {
+                double distance = getCurrentDistance();
+                bool receding = distance > lastDistance_ &&
+                                (rocket_->position() - destination_).dot(rocket_->velocity()) > 0.0;
+                recedingSteps_ = receding ? recedingSteps_ + 1 : 0;
+                lastDistance_ = distance;
+
+                if (recedingSteps_ >= RECEDING_STEPS_TO_PRUNE)
+                {
+                    if (distance > pruningBound_)
+                    {
+                        prunedAt_ = distance;
+                        terminationReason_ = TerminationReason::Pruned;
+                        break;
+                    }
+                    pruningPeak_ = std::max(pruningPeak_, distance);
+                }
+            }
+
+            // Counted in steps since the launch, so a run resumed or forked mid-way
+            // checks at the same steps as one flown in one go
+            if (pruning && (stepCount_ + 1) % PRUNING_CHECK_INTERVAL == 0)
+            {
+                double bound = minimumAchievableDistance(integrator_ == Integrator::DormandPrince ? maxStep_ : dt);
+                if (bound > pruningBound_)
+                {
+                    prunedAt_ = bound;
+                    terminationReason_ = TerminationReason::Pruned;
+                    break;
+                }
+                pruningPeak_ = std::max(pruningPeak_, bound);
+            }
+
+            if (integrator_ == Integrator::DormandPrince)
+            {
+                adaptiveStep(dt, maxStep_);
+            }
+            else
+            {
+                step(dt);
+            }
+        }
+
+        recordState(true);
+
+        if (terminationReason_ == TerminationReason::Pruned)
+        {
+            Logger::debug("Simulation pruned at time: ", time_,
+                          ", distance bound exceeds ", pruningBound_, " m");
+        }
+        else if (minDistance_ <= ARRIVAL_TOLERANCE)
+        {
+            Logger::info("Simulation stopped: Best approach at time: ", time_,
+                         ", min distance: ", minDistance_, " m");
+        }
+        else if (terminationReason_ == TerminationReason::ClosestApproach)
+        {
+            Logger::info("Simulation stopped: Coasting away after closest approach: ",
+                         minDistance_, " m");
+        }
+        else if (terminationReason_ == TerminationReason::GroundContact)
+        {
+            Logger::warning("Simulation stopped: Rocket hit the ground, closest approach: ",
+                            minDistance_, " m");
+        }
+        else if (rocket_->isOutOfFuel())
+        {
+            Logger::warning("Simulation stopped: Rocket out of fuel at distance: ",
+                            minDistance_, " m");
+        }
+        else
+        {
+            Logger::info("Simulation stopped: Maximum time reached, closest approach: ",
+                         minDistance_, " m");
+        }
+        return true;
+    }
+
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    SimulatorBase::Snapshot BasicSimulator<RocketT, AutopilotT, EnvironmentT>::snapshot() const
+    {
+        std::shared_ptr<const Autopilot> autopilot;
+        if (autopilot_)
+        {
+            autopilot = autopilot_->clone();
+            if (!autopilot)
+            {
+                throw std::logic_error("Simulator snapshot: the autopilot cannot be cloned");
+            }
+        }
+
+        return {*rocket_, std::move(autopilot), time_, stepCount_, nextStep_, minDistance_, wasClose_,
+                recedingSteps_, lastDistance_, atAtmosphereEdge_, pruningPeak_};
+    }
+
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    void BasicSimulator<RocketT, AutopilotT, EnvironmentT>::restore(const Snapshot &snapshot, AutopilotT *autopilot)
+    {
+        autopilot_ = autopilot;
+        restoreProgress(snapshot);
+    }
+
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    void BasicSimulator<RocketT, AutopilotT, EnvironmentT>::restoreProgress(const Snapshot &snapshot)
+    {
+        static_cast<Rocket &>(*rocket_) = snapshot.rocket;
+        restoreCounters(snapshot);
+    }
+
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    double BasicSimulator<RocketT, AutopilotT, EnvironmentT>::adaptiveStep(double minStep, double maxStep)
+    {
+        RocketT &vehicle = *rocket_;
+        const EnvironmentT &environment = *environment_;
+        StepTimer timer(metricsEnabled_ ? &metrics_ : nullptr);
+
+        double h = std::min(nextStep_ > 0.0 ? nextStep_ : minStep, maxStep);
+
+        double distance = getCurrentDistance();
+        double speed = vehicle.velocity().length();
+        if (speed > 0.0)
+        {
+            h = std::min(h, std::max(minStep, APPROACH_FRACTION * distance / speed));
+        }
+
+        if (isSteering())
+        {
+            StepContext context = environment.prepareStep(vehicle);
+            Vector3 passiveForce = environment.computeGravityForce(context) +
+                                   environment.computeDragForce(context,
+                                                                vehicle.getDragCoefficient(),
+                                                                vehicle.getCrossSectionArea());
+            timer.lap(&SimulationMetrics::forceNanoseconds);
+            autopilot_->update(vehicle, context, passiveForce + vehicle.thrust(), time_, h);
+            timer.lap(&SimulationMetrics::autopilotNanoseconds);
+        }
+
+        // Zero-order hold, as in step(): thrust and propellant flow stay as the
+        // autopilot left them for the whole step
+        Vector3 thrust = vehicle.thrust();
+        double massFlow = vehicle.massFlowRate();
+        double dryMass = vehicle.dryMass();
+        double dragCoefficient = vehicle.getDragCoefficient();
+        double area = vehicle.getCrossSectionArea();
+
+        bool burnout = false;
+        if (massFlow > 0.0 && vehicle.fuelMass() <= massFlow * h)
+        {
+            h = vehicle.fuelMass() / massFlow;
+            burnout = true;
+        }
+
+        auto derivative = [&](const FlightState &y)
+        {
+            double mass = dryMass + std::max(0.0, y.fuelMass);
+            Vector3 force = environment.computeGravityForce(y.position, mass) +
+                            environment.computeDragForce(y.position, y.velocity, dragCoefficient, area) +
+                            thrust;
+            return FlightState{y.velocity, force / mass, -massFlow};
+        };
+
+        FlightState y{vehicle.position(), vehicle.velocity(), vehicle.fuelMass()};
+        FlightState k1 = derivative(y);
+        FlightState next;
+
+        while (true)
+        {
+            FlightState k2 = derivative(combine(y, h, {{A21, &k1}}));
+            FlightState k3 = derivative(combine(y, h, {{A31, &k1}, {A32, &k2}}));
+            FlightState k4 = derivative(combine(y, h, {{A41, &k1}, {A42, &k2}, {A43, &k3}}));
+            FlightState k5 = derivative(combine(y, h, {{A51, &k1}, {A52, &k2}, {A53, &k3}, {A54, &k4}}));
+            FlightState k6 = derivative(combine(y, h, {{A61, &k1}, {A62, &k2}, {A63, &k3}, {A64, &k4}, {A65, &k5}}));
+            next = combine(y, h, {{B1, &k1}, {B3, &k3}, {B4, &k4}, {B5, &k5}, {B6, &k6}});
+            FlightState k7 = derivative(next);
+
+            FlightState zero{Vector3(0, 0, 0), Vector3(0, 0, 0), 0.0};
+            FlightState error = combine(zero, h, {{E1, &k1}, {E3, &k3}, {E4, &k4}, {E5, &k5}, {E6, &k6}, {E7, &k7}});
+
+            double atol = absoluteTolerance_;
+            double rtol = relativeTolerance_;
+            double sum =
+                scaledError(error.position.x(), y.position.x(), next.position.x(), atol, rtol) +
+                scaledError(error.position.y(), y.position.y(), next.position.y(), atol, rtol) +
+                scaledError(error.position.z(), y.position.z(), next.position.z(), atol, rtol) +
+                scaledError(error.velocity.x(), y.velocity.x(), next.velocity.x(), atol, rtol) +
+                scaledError(error.velocity.y(), y.velocity.y(), next.velocity.y(), atol, rtol) +
+                scaledError(error.velocity.z(), y.velocity.z(), next.velocity.z(), atol, rtol) +
+                scaledError(error.fuelMass, y.fuelMass, next.fuelMass, atol, rtol);
+            double norm = std::sqrt(sum / 7.0);
+
+            if (norm <= 1.0 || h <= MIN_ADAPTIVE_STEP)
+            {
+                double scale = norm > 0.0 ? SAFETY * std::pow(norm, -0.2) : MAX_SCALE;
+                nextStep_ = std::max(MIN_ADAPTIVE_STEP, h * std::min(MAX_SCALE, scale));
+                break;
+            }
+
+            h = std::max(MIN_ADAPTIVE_STEP, h * std::max(MIN_SCALE, SAFETY * std::pow(norm, -0.2)));
+            burnout = false;
+        }
+
+        vehicle.setState(next.position, next.velocity, burnout ? 0.0 : next.fuelMass);
+        timer.lap(&SimulationMetrics::integrationNanoseconds);
+        timer.finish(autopilot_ ? autopilot_->phase() : 0, h);
+
+        time_ += h;
+        ++stepCount_;
+        recordState();
+        return h;
+    }
+
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    bool BasicSimulator<RocketT, AutopilotT, EnvironmentT>::coast()
+    {
+        using sim::physics::KeplerOrbit;
+        namespace config = sim::utils::config;
+
+        const Vector3 start = rocket_->position();
+        KeplerOrbit orbit(start, rocket_->velocity());
+        if (!orbit.isValid())
+        {
+            return false;
+        }
+
+        // The search for the closest approach ends at re-entry, after one revolution,
+        // or once the rocket is so far out that it can only get farther away
+        double from = orbit.initialAnomaly();
+        double reentry = orbit.descendingCrossing(config::EARTH_RADIUS + config::ATMOSPHERE_HEIGHT);
+        double to = reentry;
+        if (std::isnan(reentry))
+        {
+            if (orbit.isBound())
+            {
+                to = from + 2.0 * config::PI;
+            }
+            else
+            {
+                double escape = orbit.ascendingCrossing(2.0 * destination_.length() + getCurrentDistance());
+                to = std::isnan(escape) ? from : escape;
+            }
+        }
+
+        bool limited = false;
+        double timeLeft = MAX_SIMULATION_TIME - time_;
+        if (orbit.timeAt(to) > timeLeft)
+        {
+            to = orbit.anomalyAtTime(timeLeft);
+            limited = true;
+        }
+
+        double startTime = time_;
+        auto moveTo = [&](double anomaly)
+        {
+            KeplerOrbit::State state = orbit.stateAt(anomaly);
+            rocket_->setState(state.position, state.velocity, rocket_->fuelMass());
+            time_ = startTime + orbit.timeAt(anomaly);
+            recordState(true);
+        };
+
+        sim::physics::ClosestApproach closest = findClosestApproach(orbit, destination_, from, to);
+        moveTo(closest.anomaly);
+        minDistance_ = std::min(minDistance_, closest.distance);
+        if (minDistance_ <= ARRIVAL_TOLERANCE)
+        {
+            wasClose_ = true;
+            terminationReason_ = TerminationReason::Arrived;
+        }
+        else if (limited)
+        {
+            moveTo(to);
+            time_ = MAX_SIMULATION_TIME;
+            terminationReason_ = TerminationReason::TimeLimit;
+        }
+        else if (!std::isnan(reentry))
+        {
+            moveTo(reentry);
+        }
+        else
+        {
+            terminationReason_ = TerminationReason::ClosestApproach;
+        }
+        return true;
+    }
+
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    bool BasicSimulator<RocketT, AutopilotT, EnvironmentT>::isOnGround() const
+    {
+        return rocket_->position().length() - sim::utils::config::EARTH_RADIUS <= 1e-3;
+    }
+
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    void BasicSimulator<RocketT, AutopilotT, EnvironmentT>::recordState(bool force)
+    {
+        if (recorder_)
+        {
+            recorder_->record(*rocket_, time_, stepCount_, autopilot_ ? autopilot_->phase() : 0, force);
+        }
+    }
+
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    double BasicSimulator<RocketT, AutopilotT, EnvironmentT>::minimumAchievableDistance(double dt) const
+    {
+        const RocketT &vehicle = *rocket_;
+        double minLevel = autopilot_ ? autopilot_->minimumThrustLevel() : vehicle.thrustLevel();
+
+        return distanceLowerBound(getCurrentDistance(), vehicle.velocity().length(),
+                                  vehicle.fuelMass(), vehicle.totalMass(),
+                                  vehicle.burnRate(), vehicle.specificImpulse() * sim::utils::config::g,
+                                  minLevel, MAX_SIMULATION_TIME - time_, dt);
+    }
+
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    Rocket::RocketState BasicSimulator<RocketT, AutopilotT, EnvironmentT>::getRocketState() const
+    {
+        return rocket_->getState();
+    }
+
+    template <typename RocketT, typename AutopilotT, typename EnvironmentT>
+    void BasicSimulator<RocketT, AutopilotT, EnvironmentT>::reset()
+    {
+        time_ = 0.0;
+        nextStep_ = 0.0;
+        stepCount_ = 0;
+        minDistance_ = std::numeric_limits<double>::max();
+        wasClose_ = false;
+        recedingSteps_ = 0;
+        lastDistance_ = std::numeric_limits<double>::max();
+        atAtmosphereEdge_ = false;
+        pruningPeak_ = -std::numeric_limits<double>::infinity();
+        rocket_->setPosition(Vector3(0, sim::utils::config::EARTH_RADIUS + 1.0, 0));
+        rocket_->setVelocity(Vector3(0, 0, 0));
+        rocket_->setThrustLevel(0.0);
+    }
+
+} // namespace sim::core
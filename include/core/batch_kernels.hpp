@@ -0,0 +1,138 @@
+#pragma once
+
+#include "simd.hpp"
+#include "../utils/config.hpp"
+#include <cstddef>
+
+namespace sim::core::batch
+{
+
+    // Columns of a RocketBatch handed to the integration kernels. Every array holds
+    // `count` lanes and count is a multiple of MAX_WIDTH.
+    struct LaneArrays
+    {
+        double *px, *py, *pz;
+        double *vx, *vy, *vz;
+        const double *tx, *ty, *tz;
+        const double *dryMass;
+        double *fuelMass;
+        double *thrust;
+        double *thrustLevel;
+        const double *exhaustVelocity;
+        const double *dragCoefficient;
+        const double *area;
+        const double *density;
+        const double *gravity; // acceleration magnitude at the lane's altitude
+        const double *active; // 1.0 for running lanes, 0.0 for finished ones
+        std::size_t count;
+    };
+
+    constexpr std::size_t MAX_WIDTH = 4;
+
+    using IntegrateFunction = void (*)(const LaneArrays &lanes, double dt);
+
+    // One step of gravity, drag, thrust, fuel burn and semi-implicit Euler integration
+    // with the ground clamp, lane for lane identical to Environment + Rocket::update.
+    // Finished lanes are left untouched.
+    void integrateScalar(const LaneArrays &lanes, double dt);
+#if defined(__x86_64__) || defined(_M_X64)
+    void integrateAvx2(const LaneArrays &lanes, double dt); // built with -mavx2
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    void integrateNeon(const LaneArrays &lanes, double dt);
+#endif
+
+    // Widest kernel the running CPU supports; `name` receives "avx2", "neon" or "scalar"
+    IntegrateFunction selectIntegrator(const char **name = nullptr);
+
+    template <typename Pack>
+    inline void integrate(const LaneArrays &l, double dt)
+    {
+        using namespace sim::utils::config;
+        using Mask = typename Pack::Mask;
+
+        const Pack zero = Pack::broadcast(0.0);
+        const Pack half = Pack::broadcast(0.5);
+        const Pack radius = Pack::broadcast(EARTH_RADIUS);
+        const Pack tiny = Pack::broadcast(1e-10);
+        const Pack step = Pack::broadcast(dt);
+
+        for (std::size_t i = 0; i < l.count; i += Pack::WIDTH)
+        {
+            Mask running = Pack::greater(Pack::load(l.active + i), zero);
+
+            Pack px = Pack::load(l.px + i), py = Pack::load(l.py + i), pz = Pack::load(l.pz + i);
+            Pack vx = Pack::load(l.vx + i), vy = Pack::load(l.vy + i), vz = Pack::load(l.vz + i);
+            Pack fuel = Pack::load(l.fuelMass + i);
+            Pack thrust = Pack::load(l.thrust + i);
+            Pack level = Pack::load(l.thrustLevel + i);
+            Pack dry = Pack::load(l.dryMass + i);
+
+            // Gravity
+            Pack r = Pack::sqrt(px * px + py * py + pz * pz);
+            Pack g = Pack::load(l.gravity + i);
+            Pack gravityScale = (zero - g) * (dry + fuel);
+            Pack fx = (px / r) * gravityScale;
+            Pack fy = (py / r) * gravityScale;
+            Pack fz = (pz / r) * gravityScale;
+
+            // Drag
+            Pack speed = Pack::sqrt(vx * vx + vy * vy + vz * vz);
+            Pack drag = half * Pack::load(l.dragCoefficient + i) * Pack::load(l.density + i) *
+                        speed * speed * Pack::load(l.area + i);
+            Mask moving = Pack::negate(Pack::less(speed, tiny));
+            Pack dragScale = zero - drag;
+            fx = fx + Pack::select(moving, (vx / speed) * dragScale, zero);
+            fy = fy + Pack::select(moving, (vy / speed) * dragScale, zero);
+            fz = fz + Pack::select(moving, (vz / speed) * dragScale, zero);
+
+            // Thrust
+            fx = fx + Pack::load(l.tx + i) * thrust;
+            fy = fy + Pack::load(l.ty + i) * thrust;
+            fz = fz + Pack::load(l.tz + i) * thrust;
+
+            // Fuel burn
+            Mask burning = Pack::both(Pack::greater(fuel, zero), Pack::greater(thrust, zero));
+            Pack consumed = (thrust / Pack::load(l.exhaustVelocity + i)) * step;
+            Pack newFuel = Pack::select(burning, Pack::max(zero, fuel - consumed), fuel);
+            Mask exhausted = Pack::both(burning, Pack::lessEqual(newFuel, zero));
+            Pack newThrust = Pack::select(exhausted, zero, thrust);
+            Pack newLevel = Pack::select(exhausted, zero, level);
+
+            // Semi-implicit Euler
+            Pack mass = dry + newFuel;
+            Pack nvx = vx + (fx / mass) * step;
+            Pack nvy = vy + (fy / mass) * step;
+            Pack nvz = vz + (fz / mass) * step;
+            Pack npx = px + nvx * step;
+            Pack npy = py + nvy * step;
+            Pack npz = pz + nvz * step;
+
+            // Ground clamp: project onto the surface and drop the inward radial speed
+            Pack nr = Pack::sqrt(npx * npx + npy * npy + npz * npz);
+            Mask below = Pack::less(nr - radius, zero);
+            Pack cx = (npx / nr) * radius, cy = (npy / nr) * radius, cz = (npz / nr) * radius;
+            Pack cr = Pack::sqrt(cx * cx + cy * cy + cz * cz);
+            Pack rx = cx / cr, ry = cy / cr, rz = cz / cr;
+            Pack radialSpeed = nvx * rx + nvy * ry + nvz * rz;
+            Mask inward = Pack::both(below, Pack::less(radialSpeed, zero));
+            nvx = Pack::select(inward, nvx - rx * radialSpeed, nvx);
+            nvy = Pack::select(inward, nvy - ry * radialSpeed, nvy);
+            nvz = Pack::select(inward, nvz - rz * radialSpeed, nvz);
+            npx = Pack::select(below, cx, npx);
+            npy = Pack::select(below, cy, npy);
+            npz = Pack::select(below, cz, npz);
+
+            Pack::select(running, npx, px).store(l.px + i);
+            Pack::select(running, npy, py).store(l.py + i);
+            Pack::select(running, npz, pz).store(l.pz + i);
+            Pack::select(running, nvx, vx).store(l.vx + i);
+            Pack::select(running, nvy, vy).store(l.vy + i);
+            Pack::select(running, nvz, vz).store(l.vz + i);
+            Pack::select(running, newFuel, fuel).store(l.fuelMass + i);
+            Pack::select(running, newThrust, thrust).store(l.thrust + i);
+            Pack::select(running, newLevel, level).store(l.thrustLevel + i);
+        }
+    }
+
+} // namespace sim::core::batch
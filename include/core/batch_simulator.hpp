@@ -0,0 +1,115 @@
+#pragma once
+
+#include "rocket.hpp"
+#include "autopilot.hpp"
+#include "environment.hpp"
+#include "simulator.hpp"
+#include "batch_kernels.hpp"
+#include "../utils/config.hpp"
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace sim::core
+{
+
+    // Rockets flown by gravity-turn guidance, stored column by column. The number of
+    // lanes is kept a multiple of batch::MAX_WIDTH; padding lanes are inactive.
+    struct RocketBatch
+    {
+        std::vector<double> px, py, pz;
+        std::vector<double> vx, vy, vz;
+        std::vector<double> tx, ty, tz; // thrust direction
+        std::vector<double> dryMass, fuelMass, burnRate, specificImpulse, exhaustVelocity;
+        std::vector<double> dragCoefficient, area, thrust, thrustLevel;
+
+        std::vector<double> targetAltitude, turnStartAltitude, maxAngularVelocity;
+        std::vector<GravityTurnAutopilot::Phase> phase;
+
+        std::vector<double> density, gravity; // from the Environment, refreshed every step
+        std::vector<double> active;
+        std::vector<double> minDistance, lastDistance;
+        std::vector<std::uint8_t> wasClose;
+        std::vector<std::uint32_t> recedingSteps;
+        std::vector<double> pruningPeak;
+        std::vector<std::size_t> id;
+
+        std::size_t lanes() const { return active.size(); }
+
+        void push(std::size_t rocketId, const Simulator::Snapshot &from, const GravityTurnAutopilot &autopilot);
+        // Moves running lanes to the front and shrinks the padding
+        void compact();
+        void pad();
+        batch::LaneArrays arrays();
+
+        template <typename F>
+        void forEachColumn(F &&f);
+    };
+
+    struct BatchResult
+    {
+        Rocket::RocketState state;
+        Simulator::TerminationReason reason = Simulator::TerminationReason::None;
+        double time = 0.0;
+        std::size_t steps = 0;
+        double minDistance = std::numeric_limits<double>::max();
+        double prunedDistance = 0.0;
+        double pruningPeak = -std::numeric_limits<double>::infinity(); // Simulator::pruningPeak
+    };
+
+    // Steps many rockets towards one destination in lockstep. Gravity, drag, thrust,
+    // fuel burn and integration run through SIMD kernels over the columns; guidance
+    // and the termination checks of Simulator::run are evaluated lane by lane on the
+    // same columns. Every rocket ends in the state Simulator::run would leave it in.
+    class BatchSimulator
+    {
+    private:
+        std::shared_ptr<Environment> environment_;
+        Vector3 destination_;
+        RocketBatch batch_;
+        std::vector<BatchResult> results_;
+        std::vector<double> pruningBounds_; // per rocket, like results_
+        bool recedingPruning_ = false;
+        double time_ = 0.0;
+        std::size_t steps_ = 0; // integration steps since the launch
+
+        // Where every lane starts; all lanes share one clock
+        double startTime_ = 0.0;
+        std::size_t startSteps_ = 0;
+
+        batch::IntegrateFunction integrate_;
+        const char *backend_ = "scalar";
+
+        bool checkTermination(std::size_t lane, std::size_t steps, double dt);
+        void finish(std::size_t lane, Simulator::TerminationReason reason);
+        void guide(std::size_t lane, double dt);
+        void setThrust(std::size_t lane, const Vector3 &direction, double maxAnglePerStep);
+        void setThrustLevel(std::size_t lane, double level);
+
+    public:
+        BatchSimulator(std::shared_ptr<Environment> env, const Vector3 &destination);
+
+        // Places the rocket on the launch pad like Simulator's constructor; returns its index
+        std::size_t add(const Rocket &rocket, const GravityTurnAutopilot &autopilot);
+        // Continues a run paused by Simulator::runUntil, flying `autopilot` from there.
+        // Every lane must start at the same time and step, so the rockets of one
+        // batch come either from the launch pad or from one shared prefix.
+        std::size_t add(const Simulator::Snapshot &from, const GravityTurnAutopilot &autopilot);
+        std::size_t size() const;
+
+        // For every rocket added so far, or for one of them; infinity (the default)
+        // turns pruning off
+        void setPruningBound(double bound);
+        void setPruningBound(std::size_t index, double bound);
+        void setRecedingPruning(bool enabled);
+
+        void run(double dt = sim::utils::config::TIME_STEP);
+
+        const BatchResult &result(std::size_t index) const;
+
+        // "avx2", "neon" or "scalar"
+        const char *simdBackend() const;
+    };
+
+} // namespace sim::core
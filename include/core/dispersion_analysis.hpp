@@ -0,0 +1,133 @@
+#pragma once
+
+#include "../../include/core/autopilot.hpp"
+#include "../../include/core/environment.hpp"
+#include "../../include/core/metrics.hpp"
+#include "../../include/core/rocket.hpp"
+#include "../../include/core/simulator.hpp"
+#include "../../include/core/vector3.hpp"
+#include "../../include/utils/cancellation_token.hpp"
+#include "../../include/utils/config.hpp"
+#include "../../include/utils/statistics.hpp"
+#include "../../include/utils/thread_pool.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace sim::core
+{
+
+    // Monte Carlo dispersion of one trajectory: flies the nominal rocket and
+    // autopilot (typically Optimizer::getBestRocket / getBestAutopilot) many times
+    // with perturbed vehicle, atmosphere and launch conditions, and summarizes the
+    // runs as they finish, in memory that does not grow with the number of runs.
+    //
+    // Run i draws its perturbations from its own random stream, and runs are
+    // folded into the summary in index order in chunks of RUNS_PER_CHUNK, so a seed
+    // gives the same results bit for bit on any number of threads.
+    class DispersionAnalysis
+    {
+    public:
+        // Standard deviations of the perturbations. Draws are Gaussian, cut off at
+        // three standard deviations.
+        struct Dispersions
+        {
+            double dryMass = 0.01;           // relative
+            double specificImpulse = 0.005;  // relative
+            double dragCoefficient = 0.05;   // relative
+            double atmosphericDensity = 0.05; // relative, over the whole profile
+            double launchPosition = 0.0;     // m, along each horizontal axis
+            double launchVelocity = 0.0;     // m/s, along each axis
+        };
+
+        // What run i is flown with
+        struct Perturbation
+        {
+            double dryMassFactor;
+            double specificImpulseFactor;
+            double dragCoefficientFactor;
+            double densityFactor;
+            Vector3 launchOffset;
+            Vector3 launchVelocity;
+        };
+
+        // A run-by-run quantity: exact moments and extremes, quantiles to within
+        // QuantileSketch::RELATIVE_ACCURACY
+        struct Distribution
+        {
+            sim::utils::RunningStats stats;
+            sim::utils::QuantileSketch quantiles;
+
+            void add(double value);
+            void merge(const Distribution &other);
+        };
+
+        struct Results
+        {
+            std::uint64_t runs = 0;
+            Distribution missDistance; // from the final position to the destination, m
+            Distribution fuelLeft;     // kg
+            Distribution flightTime;   // s
+            // Indexed by Simulator::TerminationReason
+            std::array<std::uint64_t, OptimizerMetrics::TERMINATION_REASONS> terminations{};
+
+            void merge(const Results &other);
+            std::string toJson() const;
+        };
+
+        // Called on the thread running run() with everything folded in so far
+        using ProgressCallback = std::function<void(const Results &)>;
+
+        static constexpr std::uint64_t DEFAULT_SEED = 42;
+        static constexpr std::size_t RUNS_PER_CHUNK = 64;
+
+    private:
+        std::shared_ptr<Environment> env_;
+        Vector3 destination_;
+        Rocket nominal_;
+        std::shared_ptr<const Autopilot> autopilot_;
+        Dispersions dispersions_;
+        std::uint64_t seed_;
+        double timeStep_ = sim::utils::config::TIME_STEP;
+        unsigned threadCount_ = 1;
+        std::shared_ptr<sim::utils::ThreadPool> pool_;
+
+        void fly(std::uint64_t run, Results &results) const;
+
+    public:
+        // The autopilot is cloned for every run, so it must support clone() and
+        // should not have flown yet. The guidance keeps using `env`; each run flies
+        // through a copy of it with the dispersed density.
+        DispersionAnalysis(std::shared_ptr<Environment> env, const Vector3 &destination,
+                           const Rocket &nominal, std::shared_ptr<const Autopilot> autopilot,
+                           std::uint64_t seed = DEFAULT_SEED);
+
+        void setDispersions(const Dispersions &dispersions);
+        const Dispersions &dispersions() const;
+
+        void setSeed(std::uint64_t seed);
+        std::uint64_t seed() const;
+
+        void setTimeStep(double dt);
+        double timeStep() const;
+
+        // Threads flying runs (0 = all hardware threads); the results do not depend on it
+        void setThreadCount(unsigned threads);
+        unsigned threadCount() const;
+        void setThreadPool(std::shared_ptr<sim::utils::ThreadPool> pool);
+
+        Perturbation perturbation(std::uint64_t run) const;
+        // A simulator set up for run `run`, to replay it (an outlier, say) alone
+        std::unique_ptr<Simulator> createSimulator(std::uint64_t run) const;
+
+        // Flies runs 0 .. runs-1, calling `progress` after every few chunks per
+        // thread. Cancelling stops within a run per thread; the results then cover
+        // the whole chunks finished before the first unfinished one.
+        Results run(std::uint64_t runs, const ProgressCallback &progress = nullptr,
+                    const sim::utils::CancellationToken *cancel = nullptr);
+    };
+
+} // namespace sim::core
@@ -1,16 +1,140 @@
 #pragma once
 
 #include "rocket.hpp"
+#include "step_context.hpp"
+#include "../physics/aerodynamics.hpp"
+#include "../physics/gravity.hpp"
+#include "../physics/hermite_table.hpp"
+#include "../utils/config.hpp"
+#include <algorithm>
 
 namespace sim::core
 {
+    enum class EnvironmentModel
+    {
+        // exp() density on every call, drag at every altitude
+        Analytic,
+        // The same profile read from an interpolation table; no drag above ATMOSPHERE_HEIGHT
+        TabulatedExponential,
+        // U.S. Standard Atmosphere 1976 density table; no drag above ATMOSPHERE_HEIGHT
+        StandardAtmosphere1976
+    };
+
+    // The density tables are cubic Hermite interpolants (physics/hermite_table.hpp)
+    // with 250 m spacing, built once per process. Relative errors against the
+    // functions they replace:
+    //   exponential density: < 2e-9 ((h/H)^4 / 384)
+    //   standard atmosphere: < 1.2e-3, at the layer boundaries where the slope of the
+    //                        profile jumps
+    // Gravity stays the inverse-square law in every model: a table lookup measured
+    // slower than the division it would replace.
     class Environment
     {
+    private:
+        EnvironmentModel model_;
+        const sim::physics::HermiteTable *densityTable_ = nullptr; // null for Analytic
+        double densityScale_ = 1.0;
+
     public:
+        explicit Environment(EnvironmentModel model = EnvironmentModel::Analytic);
+
+        EnvironmentModel model() const;
+
+        // Multiplies every density of the model, for dispersed atmospheres. At 1
+        // (the default) densities are bit for bit those of the model.
+        void setDensityScale(double scale);
+        double densityScale() const;
+
         double getGravity(double altitude) const;
         double getAtmosphericDensity(double altitude) const;
         Vector3 computeGravityForce(const Rocket &rocket) const;
         Vector3 computeDragForce(const Rocket &rocket) const;
+
+        // Forces at an arbitrary state, for integrators that evaluate intermediate stages
+        Vector3 computeGravityForce(const Vector3 &position, double mass) const;
+        Vector3 computeDragForce(const Vector3 &position, const Vector3 &velocity,
+                                 double dragCoefficient, double area) const;
+
+        // Per-step cache; the overloads below give the same results as the ones above
+        StepContext prepareStep(const Rocket &rocket) const;
+        Vector3 computeGravityForce(const StepContext &context) const;
+        Vector3 computeDragForce(const StepContext &context, double dragCoefficient, double area) const;
     };
 
-}
\ No newline at end of file
+    // What the simulators call every step (or stage) is defined here, so their step
+    // loops can inline it. Same operations as sim::physics / sim::aerodynamics, with
+    // the profiles of the model.
+
+    inline double Environment::getGravity(double altitude) const
+    {
+        return sim::physics::computeGravity(altitude);
+    }
+
+    inline double Environment::getAtmosphericDensity(double altitude) const
+    {
+        if (!densityTable_)
+        {
+            return sim::aerodynamics::computeAtmosphericDensity(altitude) * densityScale_;
+        }
+        return altitude >= sim::utils::config::ATMOSPHERE_HEIGHT ? 0.0 : (*densityTable_)(altitude) * densityScale_;
+    }
+
+    inline Vector3 Environment::computeGravityForce(const Vector3 &position, double mass) const
+    {
+        double r;
+        Vector3 direction = position.normalizedWithLength(r);
+        double g = getGravity(std::max(r - sim::utils::config::EARTH_RADIUS, 0.0));
+        return direction * (-g * mass);
+    }
+
+    inline Vector3 Environment::computeDragForce(const Vector3 &position, const Vector3 &velocity,
+                                                 double dragCoefficient, double area) const
+    {
+        double rho = getAtmosphericDensity(std::max(position.length() - sim::utils::config::EARTH_RADIUS, 0.0));
+        double v;
+        Vector3 direction = velocity.normalizedWithLength(v);
+
+        if (v < 1e-10 || rho == 0.0)
+        {
+            return Vector3(0, 0, 0);
+        }
+
+        double drag = 0.5 * dragCoefficient * rho * v * v * area;
+        return direction * (-drag);
+    }
+
+    inline StepContext Environment::prepareStep(const Rocket &rocket) const
+    {
+        StepContext context;
+        context.position = rocket.position();
+        context.velocity = rocket.velocity();
+        context.mass = rocket.totalMass();
+
+        context.radialDirection = context.position.normalizedWithLength(context.radius);
+        context.altitude = context.radius - sim::utils::config::EARTH_RADIUS;
+        context.velocityDirection = context.velocity.normalizedWithLength(context.speed);
+
+        context.density = getAtmosphericDensity(std::max(context.altitude, 0.0));
+        return context;
+    }
+
+    inline Vector3 Environment::computeGravityForce(const StepContext &context) const
+    {
+        double g = getGravity(std::max(context.altitude, 0.0));
+        return context.radialDirection * (-g * context.mass);
+    }
+
+    inline Vector3 Environment::computeDragForce(const StepContext &context,
+                                                 double dragCoefficient, double area) const
+    {
+        if (context.speed < 1e-10 || context.density == 0.0)
+        {
+            return Vector3(0, 0, 0);
+        }
+
+        double v = context.speed;
+        double drag = 0.5 * dragCoefficient * context.density * v * v * area;
+        return context.velocityDirection * (-drag);
+    }
+
+}
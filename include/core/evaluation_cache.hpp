@@ -0,0 +1,160 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace sim::core
+{
+
+    // Evaluation cache file, appended to by every EvaluationCache that opens it.
+    // Little-endian, native layout, every block RECORD_SIZE bytes:
+    //
+    //   file header   magic "RSEVAL\0\0", version, byte-order mark, padding
+    //   record*       key, score, lowest and highest pruning bound the score holds
+    //                 for, checksum of the other four
+    //
+    // A record is appended with a single write, so processes sharing the file never
+    // interleave partial records. Readers skip records whose checksum fails (a second
+    // header written by a racing creator, or a record still being written).
+    namespace evaluation_cache_format
+    {
+        constexpr char MAGIC[8] = {'R', 'S', 'E', 'V', 'A', 'L', '\0', '\0'};
+        constexpr std::uint32_t VERSION = 1;
+        constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+        struct FileHeader
+        {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t byteOrderMark;
+            std::uint64_t reserved[3];
+        };
+
+        struct Record
+        {
+            std::uint64_t key;
+            double score;
+            double low;
+            double high;
+            std::uint64_t checksum;
+        };
+
+        constexpr std::size_t RECORD_SIZE = sizeof(Record);
+        static_assert(sizeof(FileHeader) == RECORD_SIZE, "The header must keep records aligned");
+
+        std::uint64_t checksum(const Record &record);
+    }
+
+    // Scores of finished runs, keyed on a hash of everything the run depends on.
+    // Entries are kept in memory and, when the cache was opened on a file, appended
+    // to it; opening the file again, from this or another process, loads them back.
+    // Safe to use from any number of threads.
+    //
+    // A run's score only holds for some pruning bounds: from its
+    // Simulator::pruningPeak up, and below its prunedDistance if it was pruned. A
+    // lookup only hits for those, since a fresh run would end differently under any
+    // other bound.
+    class EvaluationCache
+    {
+    public:
+        using Key = std::uint64_t;
+
+        // Mantissa bits of a parameter that are kept in the key; candidates closer
+        // than about one part in 4e9 share an entry
+        static constexpr int QUANTIZATION_BITS = 32;
+
+        // Bump whenever a change to the simulation changes scores; older entries
+        // then no longer match
+        static constexpr std::uint64_t MODEL_VERSION = 2;
+
+        // Pruning bounds under which a run ends with the same score: low <= bound <
+        // high, or any bound from low up if high is infinite
+        struct BoundRange
+        {
+            double low;
+            double high;
+
+            bool contains(double bound) const;
+        };
+
+        // Hashes the inputs of a run into a key
+        class KeyBuilder
+        {
+        private:
+            std::uint64_t hash_;
+
+        public:
+            KeyBuilder();
+
+            KeyBuilder &add(std::uint64_t value);
+            // Every bit of the value
+            KeyBuilder &add(double value);
+            // The value rounded to QUANTIZATION_BITS of mantissa
+            KeyBuilder &addQuantized(double value);
+
+            Key key() const { return hash_; }
+        };
+
+    private:
+        struct Entry
+        {
+            double score;
+            BoundRange bounds;
+        };
+
+        static constexpr std::size_t SHARDS = 16;
+        struct Shard
+        {
+            mutable std::mutex mutex;
+            std::unordered_map<Key, Entry> entries;
+        };
+        std::array<Shard, SHARDS> shards_;
+
+        std::string path_;
+        std::FILE *file_ = nullptr;
+        std::mutex fileMutex_;
+        std::uint64_t loadedBytes_ = 0; // of the file, by load()
+
+        std::atomic<std::uint64_t> hits_{0};
+        std::atomic<std::uint64_t> misses_{0};
+
+        Shard &shardOf(Key key);
+        // Prefers runs that were not pruned, then the entry valid from the lower
+        // bound; true if `entry` was kept
+        bool insert(Key key, const Entry &entry);
+        std::size_t load();
+
+    public:
+        // In memory only
+        EvaluationCache();
+        // Loads the entries of `path`, creating the file if needed, and appends new
+        // ones to it. Throws std::runtime_error if the file cannot be opened or is
+        // not an evaluation cache of this version and byte order.
+        explicit EvaluationCache(const std::string &path);
+        ~EvaluationCache();
+
+        EvaluationCache(const EvaluationCache &) = delete;
+        EvaluationCache &operator=(const EvaluationCache &) = delete;
+
+        // Score of the run under `key`, if it is known for this pruning bound
+        std::optional<double> lookup(Key key, double pruningBound);
+        void store(Key key, double score, const BoundRange &bounds);
+
+        // Loads entries other processes appended since the file was opened; returns
+        // how many records were read
+        std::size_t refresh();
+
+        std::uint64_t hits() const;
+        std::uint64_t misses() const;
+        std::size_t size() const;
+        const std::string &path() const;
+    };
+
+} // namespace sim::core
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace sim::core
+{
+
+    // Where the steps of Simulator runs went. Times are wall-clock nanoseconds
+    // from std::chrono::steady_clock, so they include the cost of reading the clock
+    // (a few tens of ns per step).
+    struct SimulationMetrics
+    {
+        static constexpr std::size_t MAX_PHASES = 8; // Autopilot::phase() beyond this is folded into the last
+
+        struct Phase
+        {
+            std::uint64_t steps = 0;
+            std::uint64_t nanoseconds = 0;
+            double simulatedSeconds = 0.0;
+        };
+
+        std::uint64_t steps = 0;
+        // Gravity and drag for the step
+        std::uint64_t forceNanoseconds = 0;
+        // Autopilot::update
+        std::uint64_t autopilotNanoseconds = 0;
+        // Rocket::update, or the Runge-Kutta stages with Dormand-Prince (which
+        // evaluate the forces again)
+        std::uint64_t integrationNanoseconds = 0;
+        // Indexed by the autopilot phase during the step
+        std::array<Phase, MAX_PHASES> phases{};
+
+        void merge(const SimulationMetrics &other);
+        std::string toJson() const;
+    };
+
+    // Candidates evaluated by an Optimizer while metrics were enabled
+    struct OptimizerMetrics
+    {
+        static constexpr std::size_t TERMINATION_REASONS = 7; // Simulator::TerminationReason values
+        static constexpr std::size_t RUN_LENGTH_BUCKETS = 32;
+
+        std::uint64_t evaluations = 0;
+        double wallSeconds = 0.0; // spent inside optimize()
+
+        // Runs and the steps they took, indexed by Simulator::TerminationReason
+        std::array<std::uint64_t, TERMINATION_REASONS> terminations{};
+        std::array<std::uint64_t, TERMINATION_REASONS> terminationSteps{};
+
+        // Bucket k counts runs of [2^k, 2^(k+1)) steps; bucket 0 also takes runs of 0 steps
+        std::array<std::uint64_t, RUN_LENGTH_BUCKETS> runLengths{};
+
+        // Step timing of the candidates flown one Simulator at a time; the lockstep
+        // batch path does not time its steps and leaves this empty
+        SimulationMetrics simulation;
+
+        double evaluationsPerSecond() const;
+
+        void addRun(std::size_t terminationReason, std::uint64_t steps);
+        void merge(const OptimizerMetrics &other);
+        std::string toJson() const;
+    };
+
+    // Name of a Simulator::TerminationReason value in the JSON of these metrics
+    const char *terminationReasonName(std::size_t terminationReason);
+
+} // namespace sim::core
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "../../include/core/optimizer.hpp"
+#include "../../include/core/environment.hpp"
+#include "../../include/core/vector3.hpp"
+#include "../../include/utils/thread_pool.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sim::core
+{
+
+    // Optimizes for many destinations in one run. Destinations are handed out to
+    // the threads of one pool, and every destination's Optimizer evaluates its
+    // batches on that same pool, so threads that run out of destinations help
+    // finish the ones still running. All destinations share one Environment.
+    //
+    // Each result is the one a standalone Optimizer(env, destination, seed) gives
+    // after optimize(iterations), whatever the thread count or schedule.
+    class MultiDestinationOptimizer
+    {
+    public:
+        struct Result
+        {
+            Vector3 destination;
+            double score = 0.0;
+            Optimizer::OptimizedParameters parameters{};
+            std::string json; // Optimizer::toJson
+        };
+
+        // Applied to every Optimizer before it runs (search method, bounds, ...)
+        using Configure = std::function<void(Optimizer &)>;
+        using ResultCallback = std::function<void(std::size_t index, const Result &result)>;
+
+    private:
+        std::shared_ptr<Environment> env_;
+        std::uint64_t seed_;
+        unsigned threadCount_ = 0;
+        std::shared_ptr<sim::utils::ThreadPool> pool_;
+        Configure configure_;
+
+        void run(const std::vector<Vector3> &destinations, int iterations, const ResultCallback &onResult);
+
+    public:
+        explicit MultiDestinationOptimizer(std::shared_ptr<Environment> env,
+                                           std::uint64_t seed = Optimizer::DEFAULT_SEED);
+
+        // 0 = all hardware threads (the default)
+        void setThreadCount(unsigned threads);
+        unsigned threadCount() const;
+
+        void setConfigure(Configure configure);
+
+        // Spends `iterations` evaluations on every destination. onResult is called as
+        // each destination finishes, one call at a time, in no particular order.
+        std::vector<Result> optimize(const std::vector<Vector3> &destinations, int iterations,
+                                     const ResultCallback &onResult = nullptr);
+
+        // Writes one Optimizer::toJson record per line, in the order of
+        // `destinations` ("null" where no candidate was evaluated); a line is written
+        // once it and every line before it are done
+        void optimize(const std::vector<Vector3> &destinations, int iterations, std::ostream &out);
+    };
+
+} // namespace sim::core
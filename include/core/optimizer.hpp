@@ -1,62 +1,351 @@
+#pragma once
+
 #include "../../include/core/simulator.hpp"
 #include "../../include/core/rocket.hpp"
 #include "../../include/core/autopilot.hpp"
+#include "../../include/core/batch_simulator.hpp"
+#include "../../include/core/sampler.hpp"
+#include "../../include/core/search_strategy.hpp"
+#include "../../include/core/metrics.hpp"
+#include "../../include/core/evaluation_cache.hpp"
+#include "../../include/utils/thread_pool.hpp"
+#include "../../include/utils/config.hpp"
+#include "../../include/utils/cancellation_token.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <utility>
 #include <vector>
 #include <functional>
-#include <random>
 
 namespace sim::core
 {
 
+    // A pruned candidate scores infinity. Each search prunes against the score a
+    // candidate has to beat to matter to it, so that a pruned run is provably one
+    // the search would have discarded anyway: random sampling against the best
+    // score, differential evolution against the target vector the trial replaces.
+    // CMA-ES ranks its whole generation, so it never prunes.
+    enum class PruningMode
+    {
+        Off,
+        // Stop a candidate once its delta-v bound proves it cannot beat that score;
+        // never changes the outcome of a search. Default.
+        Bound,
+        // Bound, plus stop candidates that recede from the destination during the
+        // final approach (Simulator::setRecedingPruning). A heuristic: it may stop a
+        // run that would still have won, so results can differ from Bound.
+        Aggressive
+    };
+
     class Optimizer
     {
+    public:
+        struct OptimizedParameters
+        {
+            double dryMass;
+            double initialFuel;
+            double burnRate;
+            double specificImpulse;
+            double turnStartAltitude;
+            double turnRate;
+        };
+
+        // Search box; every field is searched between lower and upper
+        struct ParameterBounds
+        {
+            OptimizedParameters lower;
+            OptimizedParameters upper;
+        };
+
+        // Order in which the fields map onto the dimensions of the unit cube
+        static constexpr std::array<double OptimizedParameters::*, ParameterSampler::DIMENSIONS> PARAMETER_FIELDS = {
+            &OptimizedParameters::dryMass,
+            &OptimizedParameters::initialFuel,
+            &OptimizedParameters::burnRate,
+            &OptimizedParameters::specificImpulse,
+            &OptimizedParameters::turnStartAltitude,
+            &OptimizedParameters::turnRate};
+
+        // Reported after every batch of a running search
+        struct Progress
+        {
+            std::uint64_t evaluations;        // by this call so far
+            double elapsedSeconds;            // since this call started
+            double bestScore;                 // over all calls
+            OptimizedParameters bestParameters; // meaningless while bestScore is max()
+        };
+        using ProgressCallback = std::function<void(const Progress &)>;
+
+        static constexpr std::uint64_t DEFAULT_SEED = 42;
+        static constexpr std::size_t LANES_PER_GROUP = 64;
+
     private:
         std::shared_ptr<Environment> env_;
         Vector3 destination_;
-        std::shared_ptr<Rocket> bestRocket_;
-        std::shared_ptr<GravityTurnAutopilot> bestAutopilot_;
+
+        // Written by the thread running optimize(), under bestMutex_; that thread
+        // alone may read them without the lock. A new best costs no allocation: the
+        // vehicle is only built when asked for.
+        OptimizedParameters bestParameters_{};
         double bestScore_;
+        bool hasBest_ = false;
+        mutable std::mutex bestMutex_;
+        // Both objects of the same best solution, built anew; null while there is none
+        std::pair<std::shared_ptr<Rocket>, std::shared_ptr<GravityTurnAutopilot>> bestVehicle() const;
+
+        ParameterBounds bounds_;
+
+        std::uint64_t seed_;
+        SamplerType samplerType_ = SamplerType::Random;
+        std::shared_ptr<const ParameterSampler> sampler_;
+        bool customSampler_ = false;
+        std::uint64_t nextIndex_ = 0;
+        std::uint64_t layoutCount_ = 0;
+        SearchMethod searchMethod_ = SearchMethod::RandomSampling;
+        std::unique_ptr<SearchStrategy> strategy_;
+        unsigned threadCount_ = 1;
+        std::shared_ptr<sim::utils::ThreadPool> pool_;
+
+        OptimizedParameters generateRandomParameters(std::uint64_t index) const;
+
+        PruningMode pruning_ = PruningMode::Bound;
+        bool batchSimulation_ = true;
+        Simulator::Integrator integrator_ = Simulator::Integrator::SemiImplicitEuler;
+        double timeStep_ = sim::utils::config::TIME_STEP;
+        std::atomic<std::uint64_t> evaluationCount_{0};
+        std::atomic<std::uint64_t> prunedCount_{0};
+        std::atomic<std::uint64_t> cacheHits_{0};
+        std::atomic<std::uint64_t> cacheMisses_{0};
+
+        bool metricsEnabled_ = false;
+        OptimizerMetrics metrics_;
+        mutable std::mutex metricsMutex_;
+
+        bool prefixSharing_ = true;
+        bool summaryLogging_ = true;
+        std::shared_ptr<EvaluationCache> cache_;
+
+        // Stop conditions of the running call
+        std::atomic<bool> running_{false};
+        const sim::utils::CancellationToken *cancel_ = nullptr;
+        std::chrono::steady_clock::time_point deadline_ = std::chrono::steady_clock::time_point::max();
+        bool stopRequested() const;
+
+        // Vertical ascent of candidates that fly the same rocket, flown once; they
+        // are order[first, last) of a batch and continue from its snapshot
+        struct SharedAscent
+        {
+            std::size_t first = 0, last = 0;
+            std::unique_ptr<Simulator> simulator;
+            std::optional<Simulator::Snapshot> snapshot; // empty if the run ended on the way up
+
+            GravityTurnAutopilot autopilotFor(const OptimizedParameters &params) const;
+        };
 
-        void generateRandomParameters(
-            double &dryMass, double &initialFuel, double &burnRate,
-            double &specificImpulse, double &turnStartAltitude, double &turnRate);
+        // Orders the candidates for evaluation and returns how many lead it that fly
+        // a rocket of their own
+        std::size_t groupByRocket(const std::vector<OptimizedParameters> &candidates,
+                                  std::vector<std::size_t> &order,
+                                  std::vector<SharedAscent> &ascents) const;
+        void flyAscent(const std::vector<OptimizedParameters> &candidates,
+                       const std::vector<std::size_t> &order, SharedAscent &ascent,
+                       const std::vector<double> &pruningBounds, std::vector<double> &scores,
+                       OptimizerMetrics *metrics, std::vector<EvaluationCache::BoundRange> *ranges);
 
-        double evaluateParameters(
-            double dryMass, double initialFuel, double burnRate,
-            double specificImpulse, double turnStartAltitude, double turnRate);
+        // Candidates whose score provably exceeds their pruning bound (pruningBounds
+        // is indexed like `candidates`) stop early. Runs are
+        // added to `metrics` when it is not null; with `ascent` they start from its end.
+        // `range`/`ranges` receive the pruning bounds the score holds for.
+        // evaluateParameters flies a rocket, autopilot and GravityTurnSimulator held on
+        // the stack: no heap allocation, no reference counting, no virtual calls.
+        double evaluateParameters(const OptimizedParameters &params, double pruningBound,
+                                  OptimizerMetrics *metrics = nullptr,
+                                  const SharedAscent *ascent = nullptr,
+                                  EvaluationCache::BoundRange *range = nullptr);
+        void evaluateGroup(const std::vector<OptimizedParameters> &candidates,
+                           const std::size_t *indices, std::size_t count,
+                           const std::vector<double> &pruningBounds, std::vector<double> &scores,
+                           OptimizerMetrics *metrics = nullptr,
+                           const SharedAscent *ascent = nullptr,
+                           std::vector<EvaluationCache::BoundRange> *ranges = nullptr);
+        std::unique_ptr<Simulator> makeSimulator(const OptimizedParameters &params,
+                                                 std::shared_ptr<GravityTurnAutopilot> autopilot,
+                                                 double pruningBound, bool metrics) const;
+        void configureSimulator(SimulatorBase &sim, double pruningBound, bool metrics) const;
+        // Counts a finished run of `rocket` and returns its score
+        double finishRun(const SimulatorBase &sim, const Rocket &rocket, OptimizerMetrics *metrics,
+                         EvaluationCache::BoundRange *range = nullptr);
+        void forEachTask(std::size_t count, const std::function<void(std::size_t)> &task);
+        double score(const Vector3 &finalPosition, double fuelLeft) const;
+
+        Rocket buildRocket(const OptimizedParameters &params) const;
+        // With `env` the owning env_ for autopilots that leave the Optimizer, or a
+        // borrowed one for those that do not outlive the call
+        GravityTurnAutopilot buildAutopilot(const OptimizedParameters &params,
+                                            const std::shared_ptr<Environment> &env) const;
+
+        // Batches start at firstBatch candidates and double up to the full size
+        void search(int iterations, int firstBatch, const ProgressCallback &progress);
+        void optimizeBySampling(int iterations, int firstBatch, const std::function<void()> &afterBatch);
+        void optimizeByPopulation(int iterations, const std::function<void()> &afterBatch);
+
+        // Candidate i may be pruned once it provably scores above pruningBounds[i].
+        // Returns false if a stop request left candidates unevaluated; their score
+        // stays max()
+        bool evaluateBatch(const std::vector<OptimizedParameters> &candidates,
+                           const std::vector<double> &pruningBounds, std::vector<double> &scores);
+        // evaluateBatch without the cache; `ranges` is filled when not null, with NaN
+        // bounds for candidates a stop request skipped
+        bool simulateBatch(const std::vector<OptimizedParameters> &candidates,
+                           const std::vector<double> &pruningBounds,
+                           std::vector<double> &scores, std::vector<EvaluationCache::BoundRange> *ranges);
+        // The incumbent's score, for random sampling and evaluate(); infinity with
+        // pruning off
+        double pruningBound() const;
+        EvaluationCache::KeyBuilder cacheKeyBase() const;
+        void mergeBatch(const std::vector<OptimizedParameters> &candidates,
+                        const std::vector<double> &scores);
+        void acceptBest(const OptimizedParameters &params, double score);
 
     public:
-        Optimizer(std::shared_ptr<Environment> env, const Vector3 &destination);
+        Optimizer(std::shared_ptr<Environment> env, const Vector3 &destination,
+                  std::uint64_t seed = DEFAULT_SEED);
+        ~Optimizer();
 
+        // Spends `iterations` candidate evaluations with the selected search method.
+        // Repeated calls continue the same search.
         void optimize(const int iterations);
 
+        // As above, calling `progress` on this thread after every batch. Cancelling
+        // stops the search within one candidate per thread; otherwise the result is
+        // that of optimize(iterations).
+        void optimize(int iterations, const ProgressCallback &progress,
+                      const sim::utils::CancellationToken *cancel = nullptr);
+
+        // Searches until `budget` has passed or `cancel` is set. The first batches
+        // are small, so a usable best solution exists after a few evaluations per
+        // thread; the budget is not enforced until there is one. Work in flight at
+        // the deadline is finished, which may overrun it by one candidate per thread.
+        void optimizeFor(std::chrono::steady_clock::duration budget,
+                         const ProgressCallback &progress = nullptr,
+                         const sim::utils::CancellationToken *cancel = nullptr);
+
+        // optimize() may run on any thread, one call at a time per Optimizer (a second
+        // concurrent call throws std::logic_error). The getBest* functions,
+        // bestParameters() and toJson() may be called from other threads meanwhile
+        // and return the best solution found so far.
+
+        void setPruning(PruningMode mode);
+        PruningMode pruning() const;
+
+        std::uint64_t evaluationCount() const;
+        std::uint64_t prunedCount() const;
+
+        // Fly candidates through BatchSimulator instead of one Simulator each; the
+        // scores are identical either way. On by default.
+        void setBatchSimulation(bool enabled);
+        bool batchSimulation() const;
+
+        // DormandPrince takes far fewer steps per candidate; candidates are then
+        // simulated one by one, since batch simulation only integrates with Euler
+        void setIntegrator(Simulator::Integrator integrator);
+        Simulator::Integrator integrator() const;
+
+        // Step candidates are flown with (the largest step with DormandPrince).
+        // config::TIME_STEP by default.
+        void setTimeStep(double dt);
+        double timeStep() const;
+
+        // Candidates of a batch that fly the same rocket share the vertical ascent,
+        // which does not depend on the turn parameters: it is simulated once and each
+        // candidate continues from a snapshot of its end. Scores are unchanged; sweeps
+        // over the turn parameters alone skip most of their steps. On by default.
+        void setPrefixSharing(bool enabled);
+        bool prefixSharing() const;
+
+        // The summary optimize() logs when it returns (evaluations, pruned runs,
+        // cache hits). The runs of the candidates are never logged, whichever
+        // thread flies them. On by default.
+        void setSummaryLogging(bool enabled);
+        bool summaryLogging() const;
+
+        // Looks every candidate up in `cache` before simulating it and stores the
+        // scores of the runs it simulates, pruned or not. The key covers the
+        // parameters, the destination, the environment model and density scale, the
+        // time step, the integrator and the pruning mode, so one cache can serve any
+        // number of Optimizers and searches.
+        // Scores are the same with or without it. Off (null) by default.
+        void setEvaluationCache(std::shared_ptr<EvaluationCache> cache);
+        std::shared_ptr<EvaluationCache> evaluationCache() const;
+        // Candidates of this Optimizer answered from the cache and simulated for it;
+        // the cache's own counts cover every Optimizer sharing it
+        std::uint64_t cacheHits() const;
+        std::uint64_t cacheMisses() const;
+
+        // Collects OptimizerMetrics over later optimize() calls. Off by default, and
+        // free while off apart from a branch per candidate.
+        void setMetricsEnabled(bool enabled);
+        bool metricsEnabled() const;
+        OptimizerMetrics metrics() const;
+        void resetMetrics();
+        std::string metricsJson() const;
+
+        void setSearchMethod(SearchMethod method);
+        SearchMethod searchMethod() const;
+
+        static ParameterBounds defaultBounds();
+        void setBounds(const ParameterBounds &bounds);
+        const ParameterBounds &bounds() const;
+
+        // Number of threads used to evaluate candidates (0 = all hardware threads).
+        // The result for a given seed does not depend on this value.
+        void setThreadCount(unsigned threads);
+        unsigned threadCount() const;
+
+        // Evaluates candidates on `pool`, which other Optimizers may share; their
+        // tasks then interleave on its threads. setThreadCount() with another count
+        // goes back to a pool of this Optimizer's own.
+        void setThreadPool(std::shared_ptr<sim::utils::ThreadPool> pool);
+
+        // Restarts the candidate sequence
+        void setSeed(std::uint64_t seed);
+        std::uint64_t seed() const;
+
+        void setSampler(SamplerType type);
+        // Custom samplers are used as given; setSeed no longer rebuilds them
+        void setSampler(std::shared_ptr<const ParameterSampler> sampler);
+        SamplerType samplerType() const;
+
+        // Maps a point of the unit cube onto the search box
+        OptimizedParameters toParameters(const ParameterSampler::Point &point) const;
+
+        // A new, unflown copy of the best vehicle on every call; null until a
+        // candidate has been evaluated
         std::shared_ptr<Rocket> getBestRocket() const;
         std::shared_ptr<GravityTurnAutopilot> getBestAutopilot() const;
         double getBestScore() const;
 
+        // Empty until a candidate has been evaluated
+        std::optional<OptimizedParameters> bestParameters() const;
+
+        // Score of one candidate under the current settings and best score (a run
+        // that cannot beat it is pruned and scores infinity), outside of any search: the best solution
+        // and metrics() are left alone. Makes no heap allocation.
+        double evaluate(const OptimizedParameters &params);
+
+        // The best candidate with the environment, integrator and time step it was
+        // scored with (run() uses that step), unpruned; null until a candidate has
+        // been evaluated
         std::shared_ptr<Simulator> createOptimizedSimulator();
-        struct OptimizedParameters
-        {
-            double dryMass;
-            double initialFuel;
-            double burnRate;
-            double specificImpulse;
-            double turnStartAltitude;
-            double turnRate;
-        };
 
-        OptimizedParameters getOptimizedParameters() const
-        {
-            return {
-                bestRocket_->dryMass(),
-                bestRocket_->fuelMass(),
-                bestRocket_->burnRate(),
-                bestRocket_->specificImpulse(),
-                bestAutopilot_->turnStartAltitude(),
-                bestAutopilot_->turnRate()};
-        }
+        OptimizedParameters getOptimizedParameters() const;
 
+        // The best parameters as a JSON object; "null" until a candidate has been evaluated
         std::string toJson() const;
     };
 
-} // namespace sim::core
\ No newline at end of file
+} // namespace sim::core
@@ -2,6 +2,7 @@
 
 #include <string>
 #include "vector3.hpp"
+#include "../utils/config.hpp"
 
 namespace sim::core
 {
@@ -17,6 +18,8 @@ namespace sim::core
         double thrustLevel_ = 1.0;
         double specificImpulse_ = 300.0;
 
+        void clampToGround();
+
     public:
         Rocket(double dryMass, double initialFuel,
                double burnRate, double specificImpulse,
@@ -24,30 +27,39 @@ namespace sim::core
 
         void update(double dt, const Vector3 &totalForce);
 
+        // Moves to a state computed by an external integrator. Burnout and the ground
+        // clamp are handled as in update().
+        void setState(const Vector3 &position, const Vector3 &velocity, double fuelMass);
+
         // For autopilot (0 .. 1)
         void setThrustLevel(double level);
-        double thrustLevel() const;
+        double thrustLevel() const { return thrustLevel_; }
 
-        bool isOutOfFuel() const;
+        bool isOutOfFuel() const { return fuelMass_ <= 0; }
 
         void setThrust(const Vector3 &newDirection, double maxAnglePerStep);
-        Vector3 thrust() const;
+        Vector3 thrust() const { return thrustDirection_ * currentThrust_; }
 
-        double totalMass() const;
-        double dryMass() const;
-        double fuelMass() const;
+        double totalMass() const { return dryMass_ + fuelMass_; }
+        double dryMass() const { return dryMass_; }
+        double fuelMass() const { return fuelMass_; }
 
-        double specificImpulse() const;
-        double burnRate() const;
+        double specificImpulse() const { return specificImpulse_; }
+        double burnRate() const { return burnRate_; }
+        // Propellant flow at the current thrust, kg/s
+        double massFlowRate() const
+        {
+            return fuelMass_ <= 0 ? 0.0 : currentThrust_ / (specificImpulse_ * sim::utils::config::g);
+        }
 
-        double getCrossSectionArea() const;
-        double getDragCoefficient() const;
+        double getCrossSectionArea() const { return crossSectionArea_; }
+        double getDragCoefficient() const { return dragCoefficient_; }
 
-        Vector3 position() const;
-        void setPosition(const Vector3 &pos);
+        Vector3 position() const { return position_; }
+        void setPosition(const Vector3 &pos) { position_ = pos; }
 
-        Vector3 velocity() const;
-        void setVelocity(const Vector3 &vel);
+        Vector3 velocity() const { return velocity_; }
+        void setVelocity(const Vector3 &vel) { velocity_ = vel; }
 
         struct RocketState
         {
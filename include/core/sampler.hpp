@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+namespace sim::core
+{
+
+    // Produces points of the unit cube [0, 1)^DIMENSIONS. sample() depends only on the
+    // index and is safe to call from several threads, so every candidate can be
+    // generated on its own without touching a shared random engine.
+    class ParameterSampler
+    {
+    public:
+        static constexpr std::size_t DIMENSIONS = 6;
+        using Point = std::array<double, DIMENSIONS>;
+
+        virtual ~ParameterSampler() = default;
+        virtual Point sample(std::uint64_t index) const = 0;
+    };
+
+    enum class SamplerType
+    {
+        Random,
+        Sobol,
+        LatinHypercube
+    };
+
+    // Independent uniform points from a seeded counter-based stream
+    class RandomSampler : public ParameterSampler
+    {
+    private:
+        std::uint64_t seed_;
+
+    public:
+        explicit RandomSampler(std::uint64_t seed);
+        Point sample(std::uint64_t index) const override;
+    };
+
+    // Sobol low-discrepancy sequence (Joe-Kuo direction numbers) with a random digital
+    // shift derived from the seed. Prefixes of length 2^k are the best balanced.
+    class SobolSampler : public ParameterSampler
+    {
+    private:
+        static constexpr int BITS = 32;
+        std::array<std::array<std::uint32_t, BITS>, DIMENSIONS> directions_;
+        std::array<std::uint32_t, DIMENSIONS> shift_;
+
+    public:
+        explicit SobolSampler(std::uint64_t seed);
+        Point sample(std::uint64_t index) const override;
+    };
+
+    // Latin hypercube over blocks of `strata` consecutive indices: within each block
+    // every dimension hits each of the strata exactly once. Strata are assigned with a
+    // keyed bijective permutation, so no permutation table is stored.
+    class LatinHypercubeSampler : public ParameterSampler
+    {
+    private:
+        std::uint64_t seed_;
+        std::uint32_t strata_;
+
+    public:
+        LatinHypercubeSampler(std::uint64_t seed, std::uint32_t strata);
+        Point sample(std::uint64_t index) const override;
+    };
+
+    std::shared_ptr<ParameterSampler> makeSampler(SamplerType type, std::uint64_t seed,
+                                                  std::uint32_t sampleCount);
+
+} // namespace sim::core
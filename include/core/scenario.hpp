@@ -0,0 +1,60 @@
+#pragma once
+
+#include "../../include/core/optimizer.hpp"
+#include "../../include/core/environment.hpp"
+#include "../../include/core/sampler.hpp"
+#include "../../include/core/search_strategy.hpp"
+#include "../../include/core/vector3.hpp"
+#include "../../include/utils/config.hpp"
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace sim::core
+{
+
+    // One optimization job of a scenario file
+    struct Scenario
+    {
+        std::string name;
+        Vector3 destination; // physics coordinates (y includes EARTH_RADIUS)
+        int iterations = 100;
+        double timeStep = sim::utils::config::TIME_STEP;
+        EnvironmentModel environment = EnvironmentModel::Analytic;
+        SearchMethod search = SearchMethod::RandomSampling;
+        SamplerType sampler = SamplerType::Random;
+        std::uint64_t seed = Optimizer::DEFAULT_SEED;
+        Optimizer::ParameterBounds bounds = Optimizer::defaultBounds();
+
+        // Applies everything but the destination, environment and seed, which the
+        // Optimizer is constructed with
+        void configure(Optimizer &optimizer) const;
+    };
+
+    // Scenario files are INI-like. Keys before the first [section] are defaults for
+    // every scenario; each [name] section starts a scenario and may override them:
+    //
+    //   # comment
+    //   iterations = 200
+    //   environment = standard_atmosphere_1976
+    //
+    //   [leo-east]
+    //   destination = 90000 100000 40000     # x, altitude above the surface, z (m)
+    //   time_step = 0.02
+    //   search = differential_evolution      # random | differential_evolution | cma_es
+    //   sampler = sobol                      # random | sobol | latin_hypercube
+    //   seed = 7
+    //   bounds.turnRate = 0.5 0.8            # lower upper, per OptimizedParameters field
+    //
+    // environment is analytic, tabulated_exponential or standard_atmosphere_1976.
+    // Every scenario needs a destination. Throws std::runtime_error naming the
+    // source and line of the first error.
+    std::vector<Scenario> parseScenarios(std::istream &in, const std::string &source = "scenarios");
+    std::vector<Scenario> loadScenarios(const std::string &path);
+
+    const char *toString(EnvironmentModel model);
+    const char *toString(SearchMethod method);
+    const char *toString(SamplerType type);
+
+} // namespace sim::core
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "../../include/core/scenario.hpp"
+#include "../../include/core/optimizer.hpp"
+#include "../../include/core/evaluation_cache.hpp"
+#include "../../include/utils/thread_pool.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace sim::core
+{
+
+    // Runs the scenarios of a scenario file, several at a time. Scenarios are handed
+    // out to the threads of one pool and every scenario's Optimizer evaluates its
+    // batches on that same pool, as in MultiDestinationOptimizer; each result is the
+    // one a standalone Optimizer configured by the scenario gives.
+    class ScenarioRunner
+    {
+    public:
+        enum class Format
+        {
+            JsonLines,
+            Csv
+        };
+
+        struct Result
+        {
+            std::size_t index = 0; // into the scenarios
+            const Scenario *scenario = nullptr;
+            double bestScore = 0.0;
+            std::optional<Optimizer::OptimizedParameters> parameters; // empty if nothing was evaluated
+            std::uint64_t evaluations = 0;
+            std::uint64_t pruned = 0;
+            std::uint64_t cacheHits = 0;   // both 0 without an evaluation cache
+            std::uint64_t cacheMisses = 0;
+            double wallSeconds = 0.0; // from the scenario's start to its end
+        };
+
+        using ResultCallback = std::function<void(const Result &result)>;
+
+    private:
+        unsigned jobs_ = 0;
+        std::shared_ptr<sim::utils::ThreadPool> pool_;
+        std::shared_ptr<EvaluationCache> cache_;
+
+    public:
+        // Threads running scenarios and their batches (0 = all hardware threads)
+        void setJobs(unsigned jobs);
+        unsigned jobs() const;
+
+        // Shared by every scenario; null (the default) for none
+        void setEvaluationCache(std::shared_ptr<EvaluationCache> cache);
+
+        // onResult is called as each scenario finishes, one call at a time, in
+        // completion order
+        void run(const std::vector<Scenario> &scenarios, const ResultCallback &onResult);
+
+        // Streams one record per scenario as it finishes, flushing after each
+        void run(const std::vector<Scenario> &scenarios, std::ostream &out, Format format);
+
+        static std::string toJson(const Result &result);
+        static std::string csvHeader();
+        static std::string toCsv(const Result &result);
+    };
+
+} // namespace sim::core
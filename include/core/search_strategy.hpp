@@ -0,0 +1,102 @@
+#pragma once
+
+#include "sampler.hpp"
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace sim::core
+{
+
+    enum class SearchMethod
+    {
+        RandomSampling,
+        DifferentialEvolution,
+        CmaEs
+    };
+
+    // Population-based search over the unit cube. The optimizer asks for a generation,
+    // evaluates it as one batch and reports the scores back (lower is better).
+    // Proposals depend only on the seed and on the scores told so far.
+    class SearchStrategy
+    {
+    public:
+        using Point = ParameterSampler::Point;
+        static constexpr std::size_t DIMENSIONS = ParameterSampler::DIMENSIONS;
+
+        virtual ~SearchStrategy() = default;
+
+        virtual void ask(std::vector<Point> &population) = 0;
+        virtual void tell(const std::vector<Point> &population, const std::vector<double> &scores) = 0;
+
+        // Score the index-th point of the last ask() has to beat for its exact value
+        // to matter to tell(); a run that provably scores more may be cut short and
+        // told as infinity. Infinity when every score matters.
+        virtual double pruningBound(std::size_t /*index*/) const
+        {
+            return std::numeric_limits<double>::infinity();
+        }
+    };
+
+    // DE/rand/1/bin with greedy one-to-one replacement
+    class DifferentialEvolution : public SearchStrategy
+    {
+    private:
+        std::uint64_t seed_;
+        std::size_t populationSize_;
+        double differentialWeight_;
+        double crossoverRate_;
+
+        std::vector<Point> population_;
+        std::vector<double> scores_;
+        std::uint64_t generation_ = 0;
+
+    public:
+        explicit DifferentialEvolution(std::uint64_t seed,
+                                       std::size_t populationSize = 24,
+                                       double differentialWeight = 0.6,
+                                       double crossoverRate = 0.9);
+
+        void ask(std::vector<Point> &population) override;
+        void tell(const std::vector<Point> &population, const std::vector<double> &scores) override;
+        // The score of the target vector the trial competes with
+        double pruningBound(std::size_t index) const override;
+    };
+
+    // (mu/mu_w, lambda)-CMA-ES following Hansen's tutorial, with box constraints handled
+    // by repairing samples onto the unit cube and a restart when the step size collapses
+    class CmaEs : public SearchStrategy
+    {
+    private:
+        using Matrix = std::array<std::array<double, DIMENSIONS>, DIMENSIONS>;
+
+        std::uint64_t seed_;
+        std::size_t lambda_;
+        std::size_t mu_;
+        std::vector<double> weights_;
+        double mueff_, cc_, cs_, c1_, cmu_, damps_, chiN_;
+        double initialSigma_;
+
+        Point mean_;
+        double sigma_;
+        Point pc_, ps_;
+        Matrix C_, B_;
+        Point D_;
+        std::uint64_t generation_ = 0;
+        std::uint64_t restarts_ = 0;
+
+        void restart();
+        void decompose();
+
+    public:
+        explicit CmaEs(std::uint64_t seed, double initialSigma = 0.3, std::size_t lambda = 0);
+
+        void ask(std::vector<Point> &population) override;
+        void tell(const std::vector<Point> &population, const std::vector<double> &scores) override;
+
+        double sigma() const { return sigma_; }
+        const Point &mean() const { return mean_; }
+    };
+
+} // namespace sim::core
@@ -0,0 +1,111 @@
+#pragma once
+
+// Minimal fixed-width packs of doubles for the batch simulator kernels.
+// Every pack provides the same static interface, so a kernel written once as a
+// template runs on AVX2 (4 lanes), NEON (2 lanes) or plain scalar code (1 lane).
+// Masks are packs whose lanes are all-ones or all-zeros bit patterns.
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+namespace sim::core::simd
+{
+
+    struct ScalarPack
+    {
+        static constexpr std::size_t WIDTH = 1;
+        using Mask = bool;
+
+        double v;
+
+        static ScalarPack load(const double *p) { return {*p}; }
+        static ScalarPack broadcast(double x) { return {x}; }
+        void store(double *p) const { *p = v; }
+
+        friend ScalarPack operator+(ScalarPack a, ScalarPack b) { return {a.v + b.v}; }
+        friend ScalarPack operator-(ScalarPack a, ScalarPack b) { return {a.v - b.v}; }
+        friend ScalarPack operator*(ScalarPack a, ScalarPack b) { return {a.v * b.v}; }
+        friend ScalarPack operator/(ScalarPack a, ScalarPack b) { return {a.v / b.v}; }
+
+        static ScalarPack sqrt(ScalarPack a) { return {std::sqrt(a.v)}; }
+        static ScalarPack max(ScalarPack a, ScalarPack b) { return {a.v < b.v ? b.v : a.v}; }
+
+        static Mask less(ScalarPack a, ScalarPack b) { return a.v < b.v; }
+        static Mask lessEqual(ScalarPack a, ScalarPack b) { return a.v <= b.v; }
+        static Mask greater(ScalarPack a, ScalarPack b) { return a.v > b.v; }
+        static Mask both(Mask a, Mask b) { return a && b; }
+        static Mask negate(Mask a) { return !a; }
+
+        // mask ? a : b
+        static ScalarPack select(Mask mask, ScalarPack a, ScalarPack b) { return mask ? a : b; }
+    };
+
+#if defined(__AVX2__)
+    struct Avx2Pack
+    {
+        static constexpr std::size_t WIDTH = 4;
+        using Mask = __m256d;
+
+        __m256d v;
+
+        static Avx2Pack load(const double *p) { return {_mm256_loadu_pd(p)}; }
+        static Avx2Pack broadcast(double x) { return {_mm256_set1_pd(x)}; }
+        void store(double *p) const { _mm256_storeu_pd(p, v); }
+
+        friend Avx2Pack operator+(Avx2Pack a, Avx2Pack b) { return {_mm256_add_pd(a.v, b.v)}; }
+        friend Avx2Pack operator-(Avx2Pack a, Avx2Pack b) { return {_mm256_sub_pd(a.v, b.v)}; }
+        friend Avx2Pack operator*(Avx2Pack a, Avx2Pack b) { return {_mm256_mul_pd(a.v, b.v)}; }
+        friend Avx2Pack operator/(Avx2Pack a, Avx2Pack b) { return {_mm256_div_pd(a.v, b.v)}; }
+
+        static Avx2Pack sqrt(Avx2Pack a) { return {_mm256_sqrt_pd(a.v)}; }
+        static Avx2Pack max(Avx2Pack a, Avx2Pack b) { return {_mm256_max_pd(a.v, b.v)}; }
+
+        static Mask less(Avx2Pack a, Avx2Pack b) { return _mm256_cmp_pd(a.v, b.v, _CMP_LT_OQ); }
+        static Mask lessEqual(Avx2Pack a, Avx2Pack b) { return _mm256_cmp_pd(a.v, b.v, _CMP_LE_OQ); }
+        static Mask greater(Avx2Pack a, Avx2Pack b) { return _mm256_cmp_pd(a.v, b.v, _CMP_GT_OQ); }
+        static Mask both(Mask a, Mask b) { return _mm256_and_pd(a, b); }
+        static Mask negate(Mask a) { return _mm256_xor_pd(a, _mm256_castsi256_pd(_mm256_set1_epi64x(-1))); }
+
+        static Avx2Pack select(Mask mask, Avx2Pack a, Avx2Pack b) { return {_mm256_blendv_pd(b.v, a.v, mask)}; }
+    };
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    struct NeonPack
+    {
+        static constexpr std::size_t WIDTH = 2;
+        using Mask = uint64x2_t;
+
+        float64x2_t v;
+
+        static NeonPack load(const double *p) { return {vld1q_f64(p)}; }
+        static NeonPack broadcast(double x) { return {vdupq_n_f64(x)}; }
+        void store(double *p) const { vst1q_f64(p, v); }
+
+        friend NeonPack operator+(NeonPack a, NeonPack b) { return {vaddq_f64(a.v, b.v)}; }
+        friend NeonPack operator-(NeonPack a, NeonPack b) { return {vsubq_f64(a.v, b.v)}; }
+        friend NeonPack operator*(NeonPack a, NeonPack b) { return {vmulq_f64(a.v, b.v)}; }
+        friend NeonPack operator/(NeonPack a, NeonPack b) { return {vdivq_f64(a.v, b.v)}; }
+
+        static NeonPack sqrt(NeonPack a) { return {vsqrtq_f64(a.v)}; }
+        static NeonPack max(NeonPack a, NeonPack b) { return {vmaxq_f64(a.v, b.v)}; }
+
+        static Mask less(NeonPack a, NeonPack b) { return vcltq_f64(a.v, b.v); }
+        static Mask lessEqual(NeonPack a, NeonPack b) { return vcleq_f64(a.v, b.v); }
+        static Mask greater(NeonPack a, NeonPack b) { return vcgtq_f64(a.v, b.v); }
+        static Mask both(Mask a, Mask b) { return vandq_u64(a, b); }
+        static Mask negate(Mask a) { return veorq_u64(a, vdupq_n_u64(~0ULL)); }
+
+        static NeonPack select(Mask mask, NeonPack a, NeonPack b) { return {vbslq_f64(mask, a.v, b.v)}; }
+    };
+#endif
+
+} // namespace sim::core::simd
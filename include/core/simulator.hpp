@@ -1,53 +1,85 @@
 #pragma once
 
+#include "basic_simulator.hpp"
 #include "rocket.hpp"
 #include "environment.hpp"
 #include "autopilot.hpp"
 #include "../utils/config.hpp"
 #include "vector3.hpp"
+#include <functional>
 #include <memory>
+#include <vector>
 
 namespace sim::core
 {
 
-    class Simulator
+    // Flight loop of Simulator: every autopilot call goes through the Autopilot interface
+    using DynamicSimulator = BasicSimulator<Rocket, Autopilot, Environment>;
+    extern template class BasicSimulator<Rocket, Autopilot, Environment>; // simulator.cpp
+
+    // The simulator of the bindings, the CLI and tools that pick the autopilot at
+    // runtime: DynamicSimulator owning its rocket, environment and autopilot, plus
+    // cloning snapshots, forks and the sample buffer of the web front end. Code that
+    // flies a known autopilot type in a loop should use BasicSimulator with it.
+    class Simulator : public DynamicSimulator
     {
+    public:
+        // State after a step as written by stepMany(), in visual coordinates like
+        // getVisualState(); all floats, so a buffer of them reads as one Float32Array
+        struct VisualSample
+        {
+            float time;
+            float position[3];
+            float velocity[3];
+            float thrustDirection[3];
+            float fuelMass;
+            float thrustLevel;
+            float totalMass;
+        };
+        static constexpr std::size_t VISUAL_SAMPLE_FLOATS = 13;
+
     private:
-        std::shared_ptr<Rocket> rocket_;
-        std::shared_ptr<Environment> environment_;
-        std::shared_ptr<Autopilot> autopilot_;
+        std::shared_ptr<Rocket> sharedRocket_;
+        std::shared_ptr<Environment> sharedEnvironment_;
+        std::shared_ptr<Autopilot> sharedAutopilot_;
+
+        std::vector<VisualSample> samples_; // written by stepMany, capacity kept
 
-        Vector3 destination_;
-        double minDistance_ = std::numeric_limits<double>::max();
-        bool wasClose_ = false;
-        double time_ = 0.0;
+        void setAutopilot(std::shared_ptr<Autopilot> autopilot);
 
     public:
+        // Throws std::invalid_argument without a rocket or an environment
         Simulator(std::shared_ptr<Rocket> rocket,
                   std::shared_ptr<Environment> env,
                   Vector3 destination,
                   std::shared_ptr<Autopilot> autopilot = nullptr);
 
-        Vector3 calculateTotalForce() const;
-        void updateRocketState(double dt, const Vector3 &acceleration);
-
-        void run(double dt = sim::utils::config::TIME_STEP);
-        void step(double dt);
-
-        void setDestination(const Vector3 &destination);
-        void updateMinDistance(const double newMinDist);
-
-        const Vector3 &destination() const;
-        bool isArrived(double tolerance = 1500.0);
-
-        double getCurrentDistance() const;
+        // Up to n steps of dt with the termination checks of run(), without leaving
+        // C++ in between. After every stride-th step, and after the last one, the
+        // state is stored in samples(), which is overwritten by the next call. Stops
+        // early once the run ends (terminationReason() says why); returns the number
+        // of steps taken. Allocates only when a call needs more samples than any
+        // before it.
+        std::size_t stepMany(std::size_t n, std::size_t stride, double dt = sim::utils::config::TIME_STEP);
+        const VisualSample *samples() const;
+        std::size_t sampleCount() const;
 
-        double time() const;
-        const Rocket &rocket() const;
-        const Environment &environment() const;
+        // run() that returns false, between two steps, as soon as `pause` holds for
+        // the simulator about to be stepped; true once the run has ended. Calling it
+        // again resumes the run exactly where it left off.
+        bool runUntil(double dt, const std::function<bool(const Simulator &)> &pause);
 
-        Rocket::RocketState getRocketState() const;
-        void reset();
+        // Rewinds to `snapshot`; the rocket keeps its identity, the autopilot is
+        // replaced by a clone of the saved one
+        void restore(const Snapshot &snapshot);
+        // As above, continuing with `autopilot` instead of a clone; allocates nothing
+        void restore(const Snapshot &snapshot, std::shared_ptr<Autopilot> autopilot);
+        // A new simulator with the settings of this one that continues from `snapshot`
+        // with `autopilot` (a clone of the saved one if null), so runs sharing a
+        // prefix only fly it once. The fork gets its own rocket, no recorder and
+        // empty metrics.
+        std::unique_ptr<Simulator> fork(const Snapshot &snapshot,
+                                        std::shared_ptr<Autopilot> autopilot = nullptr) const;
 
     public: // VISUALISATION SECTION
         Vector3 physicsToVisual(const Vector3 &physicsPos) const;
@@ -55,4 +87,4 @@ namespace sim::core
         Rocket::RocketState getVisualState() const;
     };
 
-} // namespace sim::core
\ No newline at end of file
+} // namespace sim::core
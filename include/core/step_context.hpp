@@ -0,0 +1,25 @@
+#pragma once
+
+#include "vector3.hpp"
+
+namespace sim::core
+{
+
+    // Kinematic quantities of the rocket at the start of a step. Built once per step
+    // by Environment::prepareStep and shared by the force models and the autopilot,
+    // so radius, unit vectors and density are not recomputed by each of them.
+    struct StepContext
+    {
+        Vector3 position;
+        Vector3 velocity;
+        double mass;
+
+        double radius;            // |position|
+        double altitude;          // radius - EARTH_RADIUS, negative below the surface
+        Vector3 radialDirection;  // position.normalized()
+        double speed;             // |velocity|
+        Vector3 velocityDirection; // velocity.normalized()
+        double density;           // air density at max(altitude, 0)
+    };
+
+} // namespace sim::core
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "trajectory_recorder.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace sim::core
+{
+
+    // Binary trajectory file, written by ColumnarTrajectorySink and read by
+    // TrajectoryFile. Little-endian, native layout:
+    //
+    //   file header   magic "RSTRAJ\0\0", version, byte-order mark, record count,
+    //                 chunk count (both 0 until the writer is closed)
+    //   chunk*        chunk header (record count n, first and last time, size in
+    //                 bytes including the header), then one block per column:
+    //                 n doubles each for time, position x/y/z, velocity x/y/z,
+    //                 thrust direction x/y/z, fuel mass, total mass, thrust level;
+    //                 n uint64 steps; n bytes each for phase and burnout; padding
+    //                 to 8 bytes
+    //
+    // Chunks let the writer stream without knowing the length of the run; a file
+    // whose writer never finished is still readable up to its last complete chunk.
+    // Records are expected in time order, which time-range queries rely on.
+    namespace trajectory_format
+    {
+        constexpr char MAGIC[8] = {'R', 'S', 'T', 'R', 'A', 'J', '\0', '\0'};
+        constexpr std::uint32_t VERSION = 1;
+        constexpr std::uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+        struct FileHeader
+        {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t byteOrderMark;
+            std::uint64_t recordCount;
+            std::uint64_t chunkCount;
+        };
+
+        struct ChunkHeader
+        {
+            std::uint64_t count;
+            double firstTime;
+            double lastTime;
+            std::uint64_t byteSize;
+        };
+
+        // Double columns in file order
+        enum DoubleColumn
+        {
+            Time,
+            PositionX,
+            PositionY,
+            PositionZ,
+            VelocityX,
+            VelocityY,
+            VelocityZ,
+            ThrustX,
+            ThrustY,
+            ThrustZ,
+            FuelMass,
+            TotalMass,
+            ThrustLevel,
+            DOUBLE_COLUMNS
+        };
+
+        // Bytes a chunk of `count` records takes, header included
+        std::uint64_t chunkSize(std::uint64_t count);
+    }
+
+    // Read-only view of contiguous elements; the C++17 stand-in for std::span
+    template <typename T>
+    class Span
+    {
+    private:
+        const T *data_ = nullptr;
+        std::size_t size_ = 0;
+
+    public:
+        Span() = default;
+        Span(const T *data, std::size_t size) : data_(data), size_(size) {}
+
+        const T *data() const { return data_; }
+        std::size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        const T *begin() const { return data_; }
+        const T *end() const { return data_ + size_; }
+        const T &operator[](std::size_t i) const { return data_[i]; }
+        const T &front() const { return data_[0]; }
+        const T &back() const { return data_[size_ - 1]; }
+
+        Span subspan(std::size_t offset, std::size_t count) const { return Span(data_ + offset, count); }
+    };
+
+    // Writes records as chunks of up to chunkCapacity. Buffers one chunk per column
+    // in memory; the file header is completed by close() or the destructor.
+    class ColumnarTrajectorySink : public TrajectorySink
+    {
+    public:
+        static constexpr std::size_t DEFAULT_CHUNK_CAPACITY = 1 << 16; // records
+
+    private:
+        std::ofstream out_;
+        std::size_t chunkCapacity_;
+        std::vector<double> doubles_[trajectory_format::DOUBLE_COLUMNS];
+        std::vector<std::uint64_t> steps_;
+        std::vector<std::uint8_t> phases_;
+        std::vector<std::uint8_t> burnedOut_;
+        std::uint64_t recordCount_ = 0;
+        std::uint64_t chunkCount_ = 0;
+
+        void writeChunk();
+        void writeHeader();
+
+    public:
+        explicit ColumnarTrajectorySink(const std::string &path,
+                                        std::size_t chunkCapacity = DEFAULT_CHUNK_CAPACITY);
+        ~ColumnarTrajectorySink() override;
+
+        void write(const TrajectoryRecord *records, std::size_t count) override;
+        // Writes the buffered records as a (possibly short) chunk and updates the header
+        void flush() override;
+        void close();
+    };
+
+    // Columns of one chunk, pointing straight into the mapped file
+    struct TrajectoryChunk
+    {
+        Span<double> columns[trajectory_format::DOUBLE_COLUMNS];
+        Span<std::uint64_t> step;
+        Span<std::uint8_t> phase;     // Autopilot::phase()
+        Span<std::uint8_t> burnedOut; // 1 once the fuel is gone
+
+        std::size_t size() const { return step.size(); }
+        Span<double> time() const { return columns[trajectory_format::Time]; }
+        Span<double> column(trajectory_format::DoubleColumn c) const { return columns[c]; }
+
+        // Element i as the records the recorder produced
+        TrajectoryRecord record(std::size_t i) const;
+        Rocket::RocketState state(std::size_t i) const;
+
+        // Rows [offset, offset + count)
+        TrajectoryChunk slice(std::size_t offset, std::size_t count) const;
+    };
+
+    // Memory-maps a trajectory file. Opening costs one pass over the chunk headers;
+    // columns are never copied. Throws std::runtime_error for files that are not
+    // trajectory files or were written on a machine of different byte order.
+    class TrajectoryFile
+    {
+    private:
+        const unsigned char *data_ = nullptr;
+        std::size_t size_ = 0;
+        std::vector<unsigned char> fallback_; // file contents where mmap is unavailable
+        std::vector<TrajectoryChunk> chunks_;
+        std::size_t recordCount_ = 0;
+
+        void unmap();
+
+    public:
+        explicit TrajectoryFile(const std::string &path);
+        ~TrajectoryFile();
+
+        TrajectoryFile(const TrajectoryFile &) = delete;
+        TrajectoryFile &operator=(const TrajectoryFile &) = delete;
+
+        std::size_t recordCount() const;
+        std::size_t chunkCount() const;
+        const TrajectoryChunk &chunk(std::size_t index) const;
+
+        // Records with from <= time <= to, as chunk slices in time order. Binary
+        // search over the chunks, then within the first and last of them.
+        std::vector<TrajectoryChunk> range(double from, double to) const;
+    };
+
+} // namespace sim::core
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "rocket.hpp"
+#include "../utils/spsc_ring.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace sim::core
+{
+
+    // One sample of a trajectory. Fixed size and trivially copyable so it can go
+    // through the ring buffer by value.
+    struct TrajectoryRecord
+    {
+        double time;
+        double position[3];
+        double velocity[3];
+        double thrustDirection[3];
+        double fuelMass;
+        double totalMass;
+        double thrustLevel;
+        std::uint64_t step;
+        std::int32_t phase;    // Autopilot::phase(), 0 without an autopilot
+        std::int32_t burnedOut; // 1 once the fuel is gone
+    };
+
+    // Destination of the records drained by a TrajectoryRecorder. Called from the
+    // writer thread only, so implementations need no locking.
+    class TrajectorySink
+    {
+    public:
+        virtual ~TrajectorySink() = default;
+        virtual void write(const TrajectoryRecord *records, std::size_t count) = 0;
+        virtual void flush() {}
+    };
+
+    // One line per record with a header row
+    class CsvTrajectorySink : public TrajectorySink
+    {
+    private:
+        std::ofstream out_;
+
+    public:
+        explicit CsvTrajectorySink(const std::string &path);
+
+        void write(const TrajectoryRecord *records, std::size_t count) override;
+        void flush() override;
+    };
+
+    // Records the states a Simulator steps through and hands them to a sink on a
+    // background thread. The stepping thread only copies a record into a lock-free
+    // ring buffer and never waits for I/O: if the writer falls so far behind that
+    // the ring is full, records are dropped and counted, unless Block is asked for.
+    //
+    // Every decimation-th step is kept, as are the first step of each autopilot
+    // phase, burnout, and the states passed with force = true.
+    class TrajectoryRecorder
+    {
+    public:
+        static constexpr std::size_t DEFAULT_CAPACITY = 1 << 16; // records
+
+        enum class OverflowPolicy
+        {
+            Drop, // the record is dropped and counted in dropped(); the run never stalls. Default.
+            Block // nothing is lost, for full-resolution captures: Simulator::step stalls
+                  // until the writer has drained a slot, at the pace of the sink
+        };
+
+    private:
+        std::unique_ptr<TrajectorySink> sink_;
+        sim::utils::SpscRing<TrajectoryRecord> ring_;
+        std::size_t decimation_;
+        OverflowPolicy overflow_;
+
+        // Producer side
+        bool hasLast_ = false;
+        std::int32_t lastPhase_ = 0;
+        std::int32_t lastBurnedOut_ = 0;
+        double lastTime_ = 0.0;
+        std::atomic<std::size_t> recorded_{0};
+        std::atomic<std::size_t> dropped_{0};
+
+        std::atomic<bool> stopping_{false};
+        std::thread writer_;
+
+        void writerLoop();
+
+    public:
+        explicit TrajectoryRecorder(std::unique_ptr<TrajectorySink> sink,
+                                    std::size_t decimation = 1,
+                                    std::size_t capacity = DEFAULT_CAPACITY,
+                                    OverflowPolicy overflow = OverflowPolicy::Drop);
+        ~TrajectoryRecorder();
+
+        TrajectoryRecorder(const TrajectoryRecorder &) = delete;
+        TrajectoryRecorder &operator=(const TrajectoryRecorder &) = delete;
+
+        // Called from the stepping thread only
+        void record(const Rocket &rocket, double time, std::uint64_t step,
+                    std::int32_t phase, bool force = false);
+
+        // Writes out everything recorded so far and stops the writer thread.
+        // Later calls to record() are ignored.
+        void close();
+
+        std::size_t decimation() const;
+        OverflowPolicy overflowPolicy() const;
+        std::size_t recorded() const; // pushed into the ring
+        std::size_t dropped() const;  // lost to a full ring, always 0 with Block
+    };
+
+} // namespace sim::core
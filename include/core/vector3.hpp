@@ -1,45 +1,161 @@
 #pragma once
 
+#include "../utils/config.hpp"
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+// With SIM_VECTOR3_PADDED (CMake option PADDED_VECTOR3) a Vector3 is four aligned
+// doubles with an unused fourth lane, and element-wise operations use AVX when the
+// build targets it. Dot products and lengths are still summed in x, y, z order, so
+// the layout does not change results.
+#if defined(SIM_VECTOR3_PADDED) && defined(__AVX__)
+#include <immintrin.h>
+#define SIM_VECTOR3_AVX 1
+#define SIM_VECTOR3_CONSTEXPR inline
+#else
+#define SIM_VECTOR3_CONSTEXPR constexpr
+#endif
+
 namespace sim::core
 {
 
+#if defined(SIM_VECTOR3_PADDED)
+    class alignas(32) Vector3
+#else
     class Vector3
+#endif
     {
     private:
         double x_, y_, z_;
+#if defined(SIM_VECTOR3_PADDED)
+        double w_ = 0.0;
+#endif
+
+#if defined(SIM_VECTOR3_AVX)
+        __m256d load() const { return _mm256_load_pd(&x_); }
+        static Vector3 store(__m256d v)
+        {
+            Vector3 result;
+            _mm256_store_pd(&result.x_, v);
+            return result;
+        }
+#endif
 
     public:
-        Vector3();
-        Vector3(double x, double y, double z);
+        constexpr Vector3() : x_(0.0), y_(0.0), z_(0.0) {}
+        constexpr Vector3(double x, double y, double z) : x_(x), y_(y), z_(z) {}
 
-        double x() const;
-        double y() const;
-        double z() const;
+        constexpr double x() const { return x_; }
+        constexpr double y() const { return y_; }
+        constexpr double z() const { return z_; }
 
-        void setX(double x);
-        void setY(double y);
-        void setZ(double z);
+        constexpr void setX(double x) { x_ = x; }
+        constexpr void setY(double y) { y_ = y; }
+        constexpr void setZ(double z) { z_ = z; }
 
         static double angle(const Vector3 &first, const Vector3 &second);
         static Vector3 slerp(const Vector3 &start, const Vector3 &end, double factor);
 
-        Vector3 cross(const Vector3 &other) const;
+        constexpr Vector3 cross(const Vector3 &other) const
+        {
+            return Vector3(
+                y_ * other.z_ - z_ * other.y_,
+                z_ * other.x_ - x_ * other.z_,
+                x_ * other.y_ - y_ * other.x_);
+        }
+
+        constexpr double dot(const Vector3 &other) const
+        {
+            return x_ * other.x_ + y_ * other.y_ + z_ * other.z_;
+        }
 
-        double length() const;
-        Vector3 normalized() const;
+        constexpr double lengthSquared() const { return x_ * x_ + y_ * y_ + z_ * z_; }
+        double length() const { return std::sqrt(lengthSquared()); }
 
-        Vector3 operator+(const Vector3 &other) const;
-        Vector3 operator-(const Vector3 &other) const;
-        Vector3 operator*(double scalar) const;
-        Vector3 operator/(double scalar) const;
+        // Unit vector, or zero for vectors no longer than 1e-10
+        Vector3 normalized() const
+        {
+            double length;
+            return normalizedWithLength(length);
+        }
 
-        Vector3 &operator+=(const Vector3 &other);
-        Vector3 &operator-=(const Vector3 &other);
+        // normalized() that also hands back the length it computed
+        Vector3 normalizedWithLength(double &length) const
+        {
+            length = this->length();
+            if (length <= 1e-10)
+            {
+                return Vector3(0, 0, 0);
+            }
+            return Vector3(x_ / length, y_ / length, z_ / length);
+        }
 
-        double dot(const Vector3 &other) const;
+#if defined(SIM_VECTOR3_AVX)
+        Vector3 operator+(const Vector3 &other) const { return store(_mm256_add_pd(load(), other.load())); }
+        Vector3 operator-(const Vector3 &other) const { return store(_mm256_sub_pd(load(), other.load())); }
+        Vector3 operator*(double scalar) const { return store(_mm256_mul_pd(load(), _mm256_set1_pd(scalar))); }
+        Vector3 operator/(double scalar) const { return store(_mm256_div_pd(load(), _mm256_set1_pd(scalar))); }
+#else
+        constexpr Vector3 operator+(const Vector3 &other) const
+        {
+            return Vector3(x_ + other.x_, y_ + other.y_, z_ + other.z_);
+        }
+        constexpr Vector3 operator-(const Vector3 &other) const
+        {
+            return Vector3(x_ - other.x_, y_ - other.y_, z_ - other.z_);
+        }
+        constexpr Vector3 operator*(double scalar) const
+        {
+            return Vector3(x_ * scalar, y_ * scalar, z_ * scalar);
+        }
+        constexpr Vector3 operator/(double scalar) const
+        {
+            return Vector3(x_ / scalar, y_ / scalar, z_ / scalar);
+        }
+#endif
 
-        Vector3 &operator=(const Vector3 &other);
-        Vector3 operator-() const;
+        SIM_VECTOR3_CONSTEXPR Vector3 &operator+=(const Vector3 &other)
+        {
+            *this = *this + other;
+            return *this;
+        }
+
+        SIM_VECTOR3_CONSTEXPR Vector3 &operator-=(const Vector3 &other)
+        {
+            *this = *this - other;
+            return *this;
+        }
+
+        constexpr Vector3 operator-() const { return Vector3(-x_, -y_, -z_); }
     };
 
+    static_assert(std::is_trivially_copyable_v<Vector3>, "Vector3 is copied by value in every hot loop");
+
+    inline double Vector3::angle(const Vector3 &first, const Vector3 &second)
+    {
+        Vector3 v1 = first.normalized();
+        Vector3 v2 = second.normalized();
+        double cos = v1.x() * v2.x() + v1.y() * v2.y() + v1.z() * v2.z();
+
+        return std::acos(std::clamp(cos, -1.0, 1.0)) * 180.0 / sim::utils::config::PI;
+    }
+
+    inline Vector3 Vector3::slerp(const Vector3 &start, const Vector3 &end, double factor)
+    {
+        double dot = start.dot(end);
+        dot = std::clamp(dot, -1.0, 1.0);
+
+        double theta = std::acos(dot) * factor;
+        Vector3 relativeVec = end - start * dot;
+        double length;
+        Vector3 direction = relativeVec.normalizedWithLength(length);
+        if (length < 1e-10)
+        {
+            return start;
+        }
+
+        return start * std::cos(theta) + direction * std::sin(theta);
+    }
+
 } // namespace sim::core
@@ -6,6 +6,11 @@ namespace sim::aerodynamics
 {
     double computeAtmosphericDensity(double altitude);
 
+    // U.S. Standard Atmosphere 1976 density, kg/m3, for geometric altitudes up to
+    // 100 km. Exact layer formulas below 86 km, log-linear between the published
+    // table values above. Too slow for the step loop; Environment tabulates it.
+    double computeStandardAtmosphereDensity(double altitude);
+
     sim::core::Vector3 computeDragForce(const sim::core::Vector3 &position,
                                         const sim::core::Vector3 &velocity,
                                         double dragCoefficient,
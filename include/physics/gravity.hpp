@@ -3,11 +3,13 @@
 #include "../core/vector3.hpp"
 #include "../utils/config.hpp"
 
-using namespace sim::core;
-
 namespace sim::physics
 {
-    double computeGravity(double altitude);
+    inline double computeGravity(double altitude)
+    {
+        double r = sim::utils::config::EARTH_RADIUS + altitude;
+        return sim::utils::config::G * sim::utils::config::EARTH_MASS / (r * r);
+    }
 
     sim::core::Vector3 computeGravityForce(const sim::core::Vector3 &position, double mass);
 }
\ No newline at end of file
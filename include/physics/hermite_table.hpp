@@ -0,0 +1,65 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace sim::physics
+{
+    // Piecewise cubic Hermite interpolation on a uniform grid, built from the values
+    // and slopes of a function at the nodes. For a function with a continuous fourth
+    // derivative the error is at most h^4 / 384 * max|f''''| for spacing h. Each
+    // interval is stored as polynomial coefficients, so a lookup is one index
+    // computation, four adjacent loads and a Horner evaluation. Arguments outside
+    // the table are clamped to its ends.
+    class HermiteTable
+    {
+    private:
+        double start_, spacing_, inverseSpacing_;
+        double maxOffset_ = 0.0; // largest (x - start) / spacing, just short of the end
+        std::vector<std::array<double, 4>> coefficients_;
+
+    public:
+        template <typename Function, typename Slope>
+        HermiteTable(double start, double end, double spacing, Function &&f, Slope &&slope)
+            : start_(start), spacing_(spacing), inverseSpacing_(1.0 / spacing)
+        {
+            std::size_t intervals = static_cast<std::size_t>((end - start) / spacing + 0.5);
+            coefficients_.reserve(intervals);
+
+            double y0 = f(start);
+            double m0 = slope(start) * spacing;
+            for (std::size_t i = 0; i < intervals; ++i)
+            {
+                double x1 = start + spacing * (i + 1);
+                double y1 = f(x1);
+                double m1 = slope(x1) * spacing;
+
+                coefficients_.push_back({y0,
+                                         m0,
+                                         3.0 * (y1 - y0) - 2.0 * m0 - m1,
+                                         2.0 * (y0 - y1) + m0 + m1});
+                y0 = y1;
+                m0 = m1;
+            }
+
+            // u == intervals would index one past the last interval
+            maxOffset_ = static_cast<double>(intervals) - 1e-9;
+        }
+
+        double operator()(double x) const
+        {
+            // Signed conversion: double to size_t is much slower on x86-64
+            double u = std::clamp((x - start_) * inverseSpacing_, 0.0, maxOffset_);
+            int i = static_cast<int>(u);
+            double t = u - i;
+
+            const std::array<double, 4> &c = coefficients_[i];
+            return c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+        }
+
+        double start() const { return start_; }
+        double end() const { return start_ + spacing_ * coefficients_.size(); }
+    };
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "../core/vector3.hpp"
+#include "../utils/config.hpp"
+
+namespace sim::physics
+{
+    constexpr double EARTH_MU = sim::utils::config::G * sim::utils::config::EARTH_MASS;
+
+    // Newton iteration on M = E - e sin E (e < 1) and M = e sinh H - H (e > 1)
+    double solveKepler(double meanAnomaly, double eccentricity);
+    double solveHyperbolicKepler(double meanAnomaly, double eccentricity);
+
+    // Two-body conic through a given state. Points on it are addressed by the
+    // eccentric (ellipse) or hyperbolic (hyperbola) anomaly, counted continuously
+    // past 2 pi, which spreads samples evenly around periapsis unlike time does.
+    class KeplerOrbit
+    {
+    public:
+        struct State
+        {
+            sim::core::Vector3 position;
+            sim::core::Vector3 velocity;
+        };
+
+        KeplerOrbit(const sim::core::Vector3 &position, const sim::core::Vector3 &velocity,
+                    double mu = EARTH_MU);
+
+        // False for radial and near-parabolic trajectories, which are left to the integrator
+        bool isValid() const;
+        bool isBound() const;
+
+        double eccentricity() const;
+        double semiMajorAxis() const; // negative for hyperbolas
+        double periapsis() const;
+        double period() const; // infinity for hyperbolas
+
+        // Anomaly of the state the orbit was built from
+        double initialAnomaly() const;
+
+        double radiusAt(double anomaly) const;
+        sim::core::Vector3 positionAt(double anomaly) const;
+        State stateAt(double anomaly) const;
+
+        // Time from the initial state to the anomaly, and back
+        double timeAt(double anomaly) const;
+        double anomalyAtTime(double time) const;
+
+        // First anomaly after the initial one where the radius falls through or rises
+        // through `radius`; NaN if that never happens
+        double descendingCrossing(double radius) const;
+        double ascendingCrossing(double radius) const;
+
+    private:
+        double mu_;
+        double a_, e_;
+        double meanMotion_;
+        double initialAnomaly_, initialMeanAnomaly_;
+        sim::core::Vector3 p_, q_; // periapsis direction and its in-plane normal
+        bool valid_ = false;
+    };
+
+    struct ClosestApproach
+    {
+        double anomaly;
+        double distance;
+    };
+
+    // Point of the orbit nearest to `target` between two anomalies
+    ClosestApproach findClosestApproach(const KeplerOrbit &orbit, const sim::core::Vector3 &target,
+                                        double fromAnomaly, double toAnomaly);
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <atomic>
+
+namespace sim::utils
+{
+
+    // Asks a long-running call to stop early. cancel() may be called from any
+    // thread; the call polls isCancelled() at points where it can stop cleanly.
+    class CancellationToken
+    {
+    private:
+        std::atomic<bool> cancelled_{false};
+
+    public:
+        void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+        bool isCancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+        // Makes the token usable for another call
+        void reset() { cancelled_.store(false, std::memory_order_relaxed); }
+    };
+
+} // namespace sim::utils
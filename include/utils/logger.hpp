@@ -1,7 +1,19 @@
 #pragma once
 
+#include <iomanip>
+#include <sstream>
 #include <string>
 
+// Calls below this level are compiled out. 0 = Debug, 1 = Info, 2 = Warning,
+// 3 = Error, 4 = None; release builds (NDEBUG) keep warnings and errors only.
+#ifndef SIM_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define SIM_LOG_MIN_LEVEL 2
+#else
+#define SIM_LOG_MIN_LEVEL 0
+#endif
+#endif
+
 namespace sim::utils
 {
 
@@ -14,17 +26,74 @@ namespace sim::utils
         None
     };
 
+    constexpr LogLevel COMPILED_LOG_LEVEL = static_cast<LogLevel>(SIM_LOG_MIN_LEVEL);
+
+    // Messages are built from their arguments only once the level check has passed,
+    // then copied into a lock-free buffer owned by the calling thread. A background
+    // thread drains the buffers to std::cout, so logging never waits on the console
+    // and is safe from any thread. Lines of one thread keep their order; lines of
+    // different threads may interleave differently than they were logged. Errors
+    // are written out before error() returns.
+    //
+    // Numbers are formatted like std::to_string (fixed, six decimals); messages are
+    // cut at 500 characters.
     class Logger
     {
+    private:
+        static void write(LogLevel level, const std::string &message);
+
+        template <LogLevel Level, typename... Args>
+        static void format(const Args &...args)
+        {
+            if constexpr (Level >= COMPILED_LOG_LEVEL && Level != LogLevel::None)
+            {
+                if (isEnabled(Level))
+                {
+                    std::ostringstream out;
+                    out << std::fixed << std::setprecision(6);
+                    (out << ... << args);
+                    write(Level, out.str());
+                }
+            }
+        }
+
     public:
         static void setLevel(LogLevel level);
+        static LogLevel level();
+
+        // False below the runtime level and on muted threads
+        static bool isEnabled(LogLevel level);
 
         static void log(const std::string &message, LogLevel level = LogLevel::Info);
 
+        template <typename... Args>
+        static void debug(const Args &...args) { format<LogLevel::Debug>(args...); }
+        template <typename... Args>
+        static void info(const Args &...args) { format<LogLevel::Info>(args...); }
+        template <typename... Args>
+        static void warning(const Args &...args) { format<LogLevel::Warning>(args...); }
+        template <typename... Args>
+        static void error(const Args &...args) { format<LogLevel::Error>(args...); }
+
+        // Non-template forms, for the JavaScript bindings
         static void debug(const std::string &message);
         static void info(const std::string &message);
         static void warning(const std::string &message);
         static void error(const std::string &message);
+
+        // Writes out everything logged so far by any thread
+        static void flush();
+
+        // Silences the current thread while alive; nests
+        class ScopedMute
+        {
+        public:
+            ScopedMute();
+            ~ScopedMute();
+
+            ScopedMute(const ScopedMute &) = delete;
+            ScopedMute &operator=(const ScopedMute &) = delete;
+        };
     };
 
 } // namespace sim::utils
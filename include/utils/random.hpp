@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+namespace sim::utils
+{
+
+    // SplitMix64 finaliser: a bijective 64-bit mixer
+    constexpr std::uint64_t mix64(std::uint64_t x)
+    {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    constexpr std::uint64_t hashCombine(std::uint64_t seed, std::uint64_t value)
+    {
+        return mix64(seed ^ mix64(value));
+    }
+
+    // Counter-based random stream: the n-th number depends only on (key, n), so any
+    // stream position can be reproduced without replaying the ones before it and
+    // independent streams never share state.
+    class CounterRng
+    {
+    private:
+        std::uint64_t key_;
+        std::uint64_t counter_;
+
+    public:
+        constexpr CounterRng(std::uint64_t seed, std::uint64_t stream, std::uint64_t counter = 0)
+            : key_(hashCombine(seed, stream)), counter_(counter) {}
+
+        constexpr std::uint64_t next()
+        {
+            return mix64(key_ + mix64(counter_++));
+        }
+
+        // Uniform in [0, 1) with 53 bits of resolution
+        constexpr double uniform()
+        {
+            return static_cast<double>(next() >> 11) * 0x1.0p-53;
+        }
+
+        double uniform(double low, double high)
+        {
+            return low + (high - low) * uniform();
+        }
+
+        // Standard normal via Box-Muller; consumes two numbers
+        double normal()
+        {
+            double u1 = 1.0 - uniform();
+            double u2 = uniform();
+            return std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+        }
+
+        constexpr std::uint64_t counter() const { return counter_; }
+    };
+
+} // namespace sim::utils
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace sim::utils
+{
+
+    // Bounded queue for exactly one producer thread and one consumer thread. Neither
+    // side ever blocks or allocates: a push into a full ring fails and the caller
+    // decides what to drop. Capacity is rounded up to a power of two.
+    template <typename T>
+    class SpscRing
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Ring slots are overwritten in place");
+
+    private:
+        // Head and tail on separate cache lines so the two threads do not share one
+        static constexpr std::size_t CACHE_LINE = 64;
+
+        std::unique_ptr<T[]> slots_;
+        std::size_t mask_;
+
+        alignas(CACHE_LINE) std::atomic<std::size_t> head_{0}; // next slot to read
+        std::size_t cachedTail_ = 0;                            // consumer's view of tail_
+
+        alignas(CACHE_LINE) std::atomic<std::size_t> tail_{0}; // next slot to write
+        std::size_t cachedHead_ = 0;                            // producer's view of head_
+
+        static std::size_t roundUp(std::size_t n)
+        {
+            std::size_t capacity = 2;
+            while (capacity < n)
+            {
+                capacity *= 2;
+            }
+            return capacity;
+        }
+
+    public:
+        explicit SpscRing(std::size_t capacity)
+            : slots_(new T[roundUp(capacity)]), mask_(roundUp(capacity) - 1)
+        {
+        }
+
+        SpscRing(const SpscRing &) = delete;
+        SpscRing &operator=(const SpscRing &) = delete;
+
+        std::size_t capacity() const { return mask_ + 1; }
+
+        // Producer side
+        bool tryPush(const T &value)
+        {
+            std::size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - cachedHead_ > mask_)
+            {
+                cachedHead_ = head_.load(std::memory_order_acquire);
+                if (tail - cachedHead_ > mask_)
+                {
+                    return false;
+                }
+            }
+            slots_[tail & mask_] = value;
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer side: copies up to maxCount values into out, returns how many
+        std::size_t popInto(T *out, std::size_t maxCount)
+        {
+            std::size_t head = head_.load(std::memory_order_relaxed);
+            if (cachedTail_ == head)
+            {
+                cachedTail_ = tail_.load(std::memory_order_acquire);
+            }
+
+            std::size_t count = std::min(cachedTail_ - head, maxCount);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                out[i] = slots_[(head + i) & mask_];
+            }
+            head_.store(head + count, std::memory_order_release);
+            return count;
+        }
+    };
+
+} // namespace sim::utils
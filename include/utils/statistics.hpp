@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <map>
+
+namespace sim::utils
+{
+
+    // Count, mean, variance and extremes of a stream in one pass (Welford). merge()
+    // combines two streams (Chan et al.); merging the same parts in the same order
+    // always gives the same bits.
+    class RunningStats
+    {
+    private:
+        std::uint64_t count_ = 0;
+        double mean_ = 0.0;
+        double m2_ = 0.0; // sum of squared deviations from the mean
+        double min_ = std::numeric_limits<double>::infinity();
+        double max_ = -std::numeric_limits<double>::infinity();
+
+    public:
+        void add(double value);
+        void merge(const RunningStats &other);
+
+        std::uint64_t count() const;
+        double mean() const;
+        // Sample variance (n - 1); 0 for fewer than two values
+        double variance() const;
+        double standardDeviation() const;
+        double min() const;
+        double max() const;
+    };
+
+    // Quantiles of a stream of non-negative values to within RELATIVE_ACCURACY
+    // (DDSketch: logarithmic buckets). Only buckets that were hit are stored, and
+    // there are a fixed number of them however long the stream: values from
+    // MIN_VALUE to MAX_VALUE get their own, smaller ones (negative ones included)
+    // count as zero and larger ones share the top bucket. Buckets only hold
+    // counts, so merging is exact and order-independent.
+    class QuantileSketch
+    {
+    public:
+        static constexpr double RELATIVE_ACCURACY = 0.001;
+        static constexpr double MIN_VALUE = 1e-3;
+        static constexpr double MAX_VALUE = 1e12;
+
+    private:
+        std::map<long, std::uint64_t> buckets_;
+        std::uint64_t zeroCount_ = 0;
+        std::uint64_t count_ = 0;
+        double min_ = std::numeric_limits<double>::infinity();
+        double max_ = -std::numeric_limits<double>::infinity();
+
+        static long bucketOf(double value);
+        static double valueOf(long bucket);
+
+    public:
+        void add(double value);
+        void merge(const QuantileSketch &other);
+
+        std::uint64_t count() const;
+        // q in [0, 1]; NaN while empty. Exact at q = 0 and q = 1.
+        double quantile(double q) const;
+    };
+
+} // namespace sim::utils
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sim::utils
+{
+
+    class ThreadPool
+    {
+    private:
+        std::vector<std::thread> workers_;
+        std::deque<std::function<void()>> tasks_;
+        std::mutex mutex_;
+        std::condition_variable condition_;
+        bool stopping_ = false;
+
+        void workerLoop();
+        void enqueue(std::function<void()> task);
+
+    public:
+        // threadCount == 0 picks std::thread::hardware_concurrency(). WebAssembly
+        // builds without pthreads always get a single thread.
+        explicit ThreadPool(std::size_t threadCount);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        std::size_t size() const;
+
+        // Runs task(i) for every i in [0, count) and blocks until all of them are done.
+        // The calling thread takes part in the work, so nested calls from inside a task
+        // cannot deadlock the pool. The first exception thrown by a task is rethrown here.
+        void parallelFor(std::size_t count, const std::function<void(std::size_t)> &task);
+
+        static std::size_t defaultThreadCount();
+    };
+
+} // namespace sim::utils
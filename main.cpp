@@ -1,9 +1,17 @@
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include "include/core/simulator.hpp"
 #include "include/core/vector3.hpp"
 #include "include/core/rocket.hpp"
 #include "include/core/optimizer.hpp"
 #include "include/core/autopilot.hpp"
+#include "include/core/evaluation_cache.hpp"
+#include "include/core/scenario.hpp"
+#include "include/core/scenario_runner.hpp"
 #include "include/utils/config.hpp"
 #include "include/utils/logger.hpp"
 #include "include/core/environment.hpp"
@@ -11,29 +19,177 @@
 using namespace sim::core;
 using namespace sim::utils;
 
-int main()
+namespace
 {
+    const char *USAGE =
+        "usage: rocket_sim                       optimize and replay the demo destination\n"
+        "       rocket_sim <scenario-file> [options]\n"
+        "\n"
+        "  --jobs N          threads running scenarios and their batches (default: all)\n"
+        "  --format FORMAT   jsonl (default) or csv\n"
+        "  --output PATH     write results to PATH instead of standard output\n"
+        "  --cache PATH      share an evaluation cache file across scenarios and runs\n";
 
-    auto env = std::make_shared<Environment>();
-    Vector3 destination(90000, 100000.0 + config::EARTH_RADIUS, 40000);
+    int runDemo()
+    {
+        auto env = std::make_shared<Environment>();
+        Vector3 destination(90000, 100000.0 + config::EARTH_RADIUS, 40000);
 
-    Optimizer optimizer(env, destination);
-    optimizer.optimize(100);
+        Optimizer optimizer(env, destination);
+        optimizer.setThreadCount(0);
+        optimizer.optimize(100);
 
-    auto bestRocket = optimizer.getBestRocket();
-    auto bestAutopilot = optimizer.getBestAutopilot();
+        auto bestRocket = optimizer.getBestRocket();
+        auto bestAutopilot = optimizer.getBestAutopilot();
 
-    Logger::setLevel(LogLevel::Debug);
-    Simulator sim(bestRocket, env, destination, bestAutopilot);
-    sim.run();
+        Logger::setLevel(LogLevel::Debug);
+        Simulator sim(bestRocket, env, destination, bestAutopilot);
+        sim.run();
 
-    Vector3 finalPos = bestRocket->position();
-    double finalVel = bestRocket->velocity().length();
-    double fuelLeft = bestRocket->totalMass() - bestRocket->dryMass();
-    Logger::info("Final state: Position (" + std::to_string(finalPos.x()) + ", " +
-                 std::to_string(finalPos.y() - config::EARTH_RADIUS) + ", " + std::to_string(finalPos.z()) +
-                 "), Velocity: " + std::to_string(finalVel) +
-                 " m/s, Fuel: " + std::to_string(fuelLeft) + " kg");
+        Vector3 finalPos = bestRocket->position();
+        double finalVel = bestRocket->velocity().length();
+        double fuelLeft = bestRocket->totalMass() - bestRocket->dryMass();
+        // The demo's result, so not subject to the compiled-in log level
+        std::cout << "Final state: Position (" << finalPos.x() << ", "
+                  << finalPos.y() - config::EARTH_RADIUS << ", " << finalPos.z()
+                  << "), Velocity: " << finalVel
+                  << " m/s, Fuel: " << fuelLeft << " kg\n"
+                  << "Closest approach: " << sim.closestApproach() << " m" << std::endl;
 
-    return 0;
-}
\ No newline at end of file
+        return 0;
+    }
+
+    int runScenarios(int argc, char **argv)
+    {
+        std::string scenarioPath;
+        std::string outputPath;
+        std::string cachePath;
+        ScenarioRunner::Format format = ScenarioRunner::Format::JsonLines;
+        ScenarioRunner runner;
+
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string
+            {
+                if (i + 1 >= argc)
+                {
+                    throw std::invalid_argument(arg + " needs a value");
+                }
+                return argv[++i];
+            };
+
+            if (arg == "--help" || arg == "-h")
+            {
+                std::cout << USAGE;
+                return 0;
+            }
+            else if (arg == "--jobs" || arg == "-j")
+            {
+                std::string jobs = value();
+                char *end = nullptr;
+                long count = std::strtol(jobs.c_str(), &end, 10);
+                if (jobs.empty() || *end != '\0' || count < 0 || count > 4096)
+                {
+                    throw std::invalid_argument("--jobs needs an integer from 0 to 4096");
+                }
+                runner.setJobs(static_cast<unsigned>(count));
+            }
+            else if (arg == "--format")
+            {
+                std::string name = value();
+                if (name == "jsonl")
+                {
+                    format = ScenarioRunner::Format::JsonLines;
+                }
+                else if (name == "csv")
+                {
+                    format = ScenarioRunner::Format::Csv;
+                }
+                else
+                {
+                    throw std::invalid_argument("unknown format \"" + name + "\" (expected jsonl or csv)");
+                }
+            }
+            else if (arg == "--output" || arg == "-o")
+            {
+                outputPath = value();
+            }
+            else if (arg == "--cache")
+            {
+                cachePath = value();
+            }
+            else if (!arg.empty() && arg[0] == '-')
+            {
+                throw std::invalid_argument("unknown option " + arg);
+            }
+            else if (scenarioPath.empty())
+            {
+                scenarioPath = arg;
+            }
+            else
+            {
+                throw std::invalid_argument("more than one scenario file given");
+            }
+        }
+        if (scenarioPath.empty())
+        {
+            throw std::invalid_argument("no scenario file given");
+        }
+
+        auto scenarios = loadScenarios(scenarioPath);
+        std::shared_ptr<EvaluationCache> cache;
+        if (!cachePath.empty())
+        {
+            cache = std::make_shared<EvaluationCache>(cachePath);
+            runner.setEvaluationCache(cache);
+        }
+
+        // The log goes to standard output, where it would mix with the records
+        Logger::setLevel(LogLevel::Error);
+
+        // Totals over every scenario; each record has its own counts
+        auto reportCache = [&]
+        {
+            if (cache)
+            {
+                std::cerr << "Evaluation cache: " << cache->hits() << " hits, " << cache->misses()
+                          << " misses, " << cache->size() << " entries\n";
+            }
+        };
+
+        if (outputPath.empty())
+        {
+            runner.run(scenarios, std::cout, format);
+            reportCache();
+            return 0;
+        }
+        std::ofstream out(outputPath);
+        if (!out)
+        {
+            throw std::runtime_error("Cannot open output file: " + outputPath);
+        }
+        runner.run(scenarios, out, format);
+        reportCache();
+        return out ? 0 : 1;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        return runDemo();
+    }
+
+    try
+    {
+        return runScenarios(argc, argv);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "rocket_sim: " << e.what() << '\n'
+                  << USAGE;
+        return 1;
+    }
+}
@@ -25,6 +25,12 @@ namespace sim::core
     }
 
     void GravityTurnAutopilot::update(Rocket &rocket, const Vector3 &totalForce, double time, double dt)
+    {
+        update(rocket, environment_->prepareStep(rocket), totalForce, time, dt);
+    }
+
+    void GravityTurnAutopilot::update(Rocket &rocket, const StepContext &context,
+                                      const Vector3 &totalForce, double time, double dt)
     {
         if (rocket.isOutOfFuel())
         {
@@ -34,7 +40,7 @@ namespace sim::core
             return;
         }
 
-        double altitude = rocket.position().length() - sim::utils::config::EARTH_RADIUS;
+        double altitude = context.altitude;
         if (altitude < 0 && (phase_ != Phase::TargetApproach))
         {
             altitude = 0;
@@ -42,22 +48,22 @@ namespace sim::core
         }
 
         //*Logger::info("Autopilot: Current altitude: " + std::to_string(altitude) + " m");
-        Vector3 velocity = rocket.velocity();
-        Vector3 position = rocket.position();
-        Vector3 toTarget = (destination_ - position).normalized();
-        double distanceToTarget = (destination_ - position).length();
+        const Vector3 &velocity = context.velocity;
+        const Vector3 &position = context.position;
+        double distanceToTarget;
+        Vector3 toTarget = (destination_ - position).normalizedWithLength(distanceToTarget);
         //*Logger::info("Autopilot: Distance to target: " + std::to_string(distanceToTarget) + " m\n");
 
         if (phase_ == Phase::VerticalAscent)
         {
-            if (altitude >= targetAltitude_ * 0.5)
+            if (altitude >= turnDecisionAltitude())
             {
                 phase_ = Phase::GravityTurn;
-                Logger::info("Gravity Turn initiated at altitude: " + std::to_string(altitude) + "\n");
+                Logger::info("Gravity Turn initiated at altitude: ", altitude, "\n");
             }
             else
             {
-                rocket.setThrust(rocket.position().normalized(), maxAngularVelocity_ * dt);
+                rocket.setThrust(context.radialDirection, maxAngularVelocity_ * dt);
                 rocket.setThrustLevel(1.0);
                 return;
             }
@@ -65,7 +71,7 @@ namespace sim::core
 
         if (phase_ == Phase::GravityTurn)
         {
-            Vector3 desiredDirection = calculateOptimalTurnDirection(rocket, totalForce);
+            Vector3 desiredDirection = calculateOptimalTurnDirection(context, totalForce);
             Vector3 currentDirection = rocket.thrust().normalized();
 
             double maxAngleChange = maxAngularVelocity_ * dt;
@@ -89,14 +95,12 @@ namespace sim::core
 
         if (phase_ == Phase::TargetApproach)
         {
-            double distanceToTarget = (destination_ - rocket.position()).length();
-
             if (distanceToTarget < 1500.0)
             {
-                Logger::info("Target reached, thrust disabled at time: " + std::to_string(time) +
-                             ", Position: (" + std::to_string(position.x()) + ", " +
-                             std::to_string(position.y() - sim::utils::config::EARTH_RADIUS) + ", " + std::to_string(position.z()) +
-                             "), Velocity: " + std::to_string(velocity.length()) + " m/s");
+                Logger::info("Target reached, thrust disabled at time: ", time,
+                             ", Position: (", position.x(), ", ",
+                             position.y() - sim::utils::config::EARTH_RADIUS, ", ", position.z(),
+                             "), Velocity: ", velocity.length(), " m/s");
                 return;
             }
 
@@ -119,11 +123,40 @@ namespace sim::core
         }
     }
 
+    std::shared_ptr<Autopilot> GravityTurnAutopilot::clone() const
+    {
+        return std::make_shared<GravityTurnAutopilot>(*this);
+    }
+
+    GravityTurnAutopilot GravityTurnAutopilot::withTurn(double turnStartAltitude, double turnRate) const
+    {
+        GravityTurnAutopilot copy(*this);
+        copy.turnStartAltitude_ = turnStartAltitude;
+        copy.turnRate_ = turnRate;
+        return copy;
+    }
+
+    bool GravityTurnAutopilot::isVerticalAscentOver(const Rocket &rocket) const
+    {
+        if (phase_ != Phase::VerticalAscent)
+        {
+            return true;
+        }
+        // The altitude update() sees, clamped the same way
+        double altitude = std::max(rocket.position().length() - sim::utils::config::EARTH_RADIUS, 0.0);
+        return altitude >= turnDecisionAltitude();
+    }
+
     Vector3 GravityTurnAutopilot::calculateOptimalTurnDirection(const Rocket &rocket, const Vector3 &totalForce) const
     {
-        Vector3 toTarget = (destination_ - rocket.position()).normalized();
-        Vector3 velocityDir = rocket.velocity().normalized();
-        Vector3 positionDir = rocket.position().normalized();
+        return calculateOptimalTurnDirection(environment_->prepareStep(rocket), totalForce);
+    }
+
+    Vector3 GravityTurnAutopilot::calculateOptimalTurnDirection(const StepContext &context, const Vector3 &totalForce) const
+    {
+        Vector3 toTarget = (destination_ - context.position).normalized();
+        const Vector3 &velocityDir = context.velocityDirection;
+        const Vector3 &positionDir = context.radialDirection;
 
         Vector3 horizontalPlaneNormal = positionDir;
         Vector3 toTargetHorizontal = toTarget - horizontalPlaneNormal * toTarget.dot(horizontalPlaneNormal);
@@ -134,12 +167,12 @@ namespace sim::core
 
         toTargetHorizontal = toTargetHorizontal.normalized();
 
-        double altitude = rocket.position().length() - config::EARTH_RADIUS;
+        double altitude = context.altitude;
         double turnProgress = std::clamp((altitude - turnStartAltitude_) / (targetAltitude_ - turnStartAltitude_), 0.0, 1.0);
 
         Vector3 desiredDirection = Vector3::slerp(positionDir, toTargetHorizontal, turnProgress);
 
-        Vector3 gravityDir = environment_->computeGravityForce(rocket).normalized();
+        Vector3 gravityDir = environment_->computeGravityForce(context).normalized();
         double gravityCompensation = (1.0 - turnProgress);
         desiredDirection = (desiredDirection - gravityDir * gravityCompensation).normalized();
 
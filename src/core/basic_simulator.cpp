@@ -0,0 +1,209 @@
+#include "../../include/core/basic_simulator.hpp"
+#include <stdexcept>
+
+using namespace sim::utils;
+
+namespace sim::core
+{
+
+    SimulatorBase::SimulatorBase(const Vector3 &destination)
+        : destination_(destination)
+    {
+    }
+
+    void SimulatorBase::restoreCounters(const Snapshot &snapshot)
+    {
+        time_ = snapshot.time;
+        stepCount_ = snapshot.stepCount;
+        nextStep_ = snapshot.nextStep;
+        minDistance_ = snapshot.minDistance;
+        wasClose_ = snapshot.wasClose;
+        recedingSteps_ = snapshot.recedingSteps;
+        lastDistance_ = snapshot.lastDistance;
+        atAtmosphereEdge_ = snapshot.atAtmosphereEdge;
+        pruningPeak_ = snapshot.pruningPeak;
+        terminationReason_ = TerminationReason::None;
+        prunedAt_ = 0.0;
+    }
+
+    void SimulatorBase::setDestination(const Vector3 &destination)
+    {
+        destination_ = destination;
+    }
+
+    const Vector3 &SimulatorBase::destination() const
+    {
+        return destination_;
+    }
+
+    void SimulatorBase::updateMinDistance(const double newMinDist)
+    {
+        minDistance_ = newMinDist;
+    }
+
+    double SimulatorBase::time() const
+    {
+        return time_;
+    }
+
+    void SimulatorBase::setRecorder(std::shared_ptr<TrajectoryRecorder> recorder)
+    {
+        recorder_ = std::move(recorder);
+    }
+
+    const std::shared_ptr<TrajectoryRecorder> &SimulatorBase::recorder() const
+    {
+        return recorder_;
+    }
+
+    void SimulatorBase::setMetricsEnabled(bool enabled)
+    {
+        metricsEnabled_ = enabled;
+    }
+
+    bool SimulatorBase::metricsEnabled() const
+    {
+        return metricsEnabled_;
+    }
+
+    const SimulationMetrics &SimulatorBase::metrics() const
+    {
+        return metrics_;
+    }
+
+    void SimulatorBase::resetMetrics()
+    {
+        metrics_ = SimulationMetrics();
+    }
+
+    void SimulatorBase::setCoastAfterBurnout(bool enabled)
+    {
+        coastAfterBurnout_ = enabled;
+    }
+
+    bool SimulatorBase::coastAfterBurnout() const
+    {
+        return coastAfterBurnout_;
+    }
+
+    double SimulatorBase::closestApproach() const
+    {
+        return minDistance_;
+    }
+
+    void SimulatorBase::setIntegrator(Integrator integrator)
+    {
+        integrator_ = integrator;
+        nextStep_ = 0.0;
+    }
+
+    SimulatorBase::Integrator SimulatorBase::integrator() const
+    {
+        return integrator_;
+    }
+
+    void SimulatorBase::setTolerances(double absolute, double relative)
+    {
+        if (absolute <= 0.0 || relative < 0.0)
+        {
+            throw std::invalid_argument("Integrator tolerances must be positive");
+        }
+        absoluteTolerance_ = absolute;
+        relativeTolerance_ = relative;
+    }
+
+    void SimulatorBase::setMaxStep(double maxStep)
+    {
+        if (maxStep <= 0.0)
+        {
+            throw std::invalid_argument("Maximum step must be positive");
+        }
+        maxStep_ = maxStep;
+    }
+
+    double SimulatorBase::maxStep() const
+    {
+        return maxStep_;
+    }
+
+    void SimulatorBase::setTimeStep(double dt)
+    {
+        if (dt <= 0.0)
+        {
+            throw std::invalid_argument("Time step must be positive");
+        }
+        timeStep_ = dt;
+    }
+
+    double SimulatorBase::timeStep() const
+    {
+        return timeStep_;
+    }
+
+    std::size_t SimulatorBase::stepCount() const
+    {
+        return stepCount_;
+    }
+
+    void SimulatorBase::setPruningBound(double bound)
+    {
+        pruningBound_ = bound;
+    }
+
+    double SimulatorBase::pruningBound() const
+    {
+        return pruningBound_;
+    }
+
+    void SimulatorBase::setRecedingPruning(bool enabled)
+    {
+        recedingPruning_ = enabled;
+    }
+
+    double SimulatorBase::prunedDistance() const
+    {
+        return prunedAt_;
+    }
+
+    double SimulatorBase::pruningPeak() const
+    {
+        return pruningPeak_;
+    }
+
+    SimulatorBase::TerminationReason SimulatorBase::terminationReason() const
+    {
+        return terminationReason_;
+    }
+
+    double distanceLowerBound(double distance, double speed,
+                              double fuelMass, double totalMass,
+                              double burnRate, double exhaustVelocity,
+                              double minThrustLevel, double timeLeft, double dt)
+    {
+        // The run ends once the fuel is gone, which bounds the time left if the thrust
+        // level can never drop to zero before that
+        if (minThrustLevel <= 0.0 || burnRate <= 0.0)
+        {
+            return 0.0;
+        }
+
+        double remaining = std::min(fuelMass / (minThrustLevel * burnRate), timeLeft) + 2.0 * dt;
+
+        // Largest possible speed gain: burn everything at full thrust, then coast.
+        // Integrating the rocket equation over the burn gives the distance it adds.
+        double burnTime = std::min(fuelMass / burnRate, remaining);
+        double finalMass = totalMass - burnRate * burnTime;
+        double massRatioLog = std::log(totalMass / finalMass);
+        double deltaV = exhaustVelocity * massRatioLog;
+        double thrustReach = exhaustVelocity * (burnTime - (finalMass / burnRate) * massRatioLog) +
+                             deltaV * (remaining - burnTime);
+
+        // Drag only ever slows the rocket; gravity is strongest at the surface
+        double maxGravity = config::G * config::EARTH_MASS / (config::EARTH_RADIUS * config::EARTH_RADIUS);
+        double reach = speed * remaining + thrustReach + 0.5 * maxGravity * remaining * remaining;
+
+        // Margin for the integration error of the fixed-step scheme
+        return std::max(0.0, distance - 1.01 * reach);
+    }
+
+}
@@ -0,0 +1,45 @@
+#include "../../include/core/batch_kernels.hpp"
+
+namespace sim::core::batch
+{
+
+#if defined(__x86_64__) || defined(_M_X64)
+    bool avx2KernelCompiled(); // batch_kernels_avx2.cpp
+#endif
+
+    void integrateScalar(const LaneArrays &lanes, double dt)
+    {
+        integrate<simd::ScalarPack>(lanes, dt);
+    }
+
+#if defined(__ARM_NEON) && defined(__aarch64__)
+    void integrateNeon(const LaneArrays &lanes, double dt)
+    {
+        integrate<simd::NeonPack>(lanes, dt);
+    }
+#endif
+
+    IntegrateFunction selectIntegrator(const char **name)
+    {
+        const char *selected = "scalar";
+        IntegrateFunction function = &integrateScalar;
+
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(__GNUC__)
+        if (avx2KernelCompiled() && __builtin_cpu_supports("avx2"))
+        {
+            selected = "avx2";
+            function = &integrateAvx2;
+        }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+        selected = "neon";
+        function = &integrateNeon;
+#endif
+
+        if (name)
+        {
+            *name = selected;
+        }
+        return function;
+    }
+
+} // namespace sim::core::batch
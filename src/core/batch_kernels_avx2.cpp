@@ -0,0 +1,33 @@
+// Built with -mavx2 (see CMakeLists.txt) and only called after a runtime CPU check.
+// Keep this file down to the AVX2 instantiation: any other inline function emitted
+// here could be picked by the linker for code that runs on CPUs without AVX2.
+#if defined(__x86_64__) || defined(_M_X64)
+#include "../../include/core/batch_kernels.hpp"
+
+namespace sim::core::batch
+{
+
+#if defined(__AVX2__)
+    bool avx2KernelCompiled()
+    {
+        return true;
+    }
+
+    void integrateAvx2(const LaneArrays &lanes, double dt)
+    {
+        integrate<simd::Avx2Pack>(lanes, dt);
+    }
+#else
+    bool avx2KernelCompiled()
+    {
+        return false;
+    }
+
+    void integrateAvx2(const LaneArrays &lanes, double dt)
+    {
+        integrateScalar(lanes, dt);
+    }
+#endif
+
+} // namespace sim::core::batch
+#endif
@@ -0,0 +1,483 @@
+#include "../../include/core/batch_simulator.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace sim::utils;
+
+namespace sim::core
+{
+
+    using Phase = GravityTurnAutopilot::Phase;
+    using TerminationReason = Simulator::TerminationReason;
+
+    template <typename F>
+    void RocketBatch::forEachColumn(F &&f)
+    {
+        f(px), f(py), f(pz);
+        f(vx), f(vy), f(vz);
+        f(tx), f(ty), f(tz);
+        f(dryMass), f(fuelMass), f(burnRate), f(specificImpulse), f(exhaustVelocity);
+        f(dragCoefficient), f(area), f(thrust), f(thrustLevel);
+        f(targetAltitude), f(turnStartAltitude), f(maxAngularVelocity);
+        f(phase);
+        f(density), f(gravity), f(active), f(minDistance), f(lastDistance);
+        f(wasClose), f(recedingSteps), f(pruningPeak), f(id);
+    }
+
+    void RocketBatch::push(std::size_t rocketId, const Simulator::Snapshot &from, const GravityTurnAutopilot &autopilot)
+    {
+        const Rocket &rocket = from.rocket;
+        Rocket::RocketState state = rocket.getState();
+
+        px.push_back(state.position.x());
+        py.push_back(state.position.y());
+        pz.push_back(state.position.z());
+        vx.push_back(state.velocity.x());
+        vy.push_back(state.velocity.y());
+        vz.push_back(state.velocity.z());
+        tx.push_back(state.thrustDirection.x());
+        ty.push_back(state.thrustDirection.y());
+        tz.push_back(state.thrustDirection.z());
+
+        dryMass.push_back(rocket.dryMass());
+        fuelMass.push_back(rocket.fuelMass());
+        burnRate.push_back(rocket.burnRate());
+        specificImpulse.push_back(rocket.specificImpulse());
+        exhaustVelocity.push_back(rocket.specificImpulse() * config::g);
+        dragCoefficient.push_back(rocket.getDragCoefficient());
+        area.push_back(rocket.getCrossSectionArea());
+        thrust.push_back(rocket.thrust().length());
+        thrustLevel.push_back(state.thrustLevel);
+
+        targetAltitude.push_back(autopilot.targetAltitude());
+        turnStartAltitude.push_back(autopilot.turnStartAltitude());
+        maxAngularVelocity.push_back(autopilot.maxAngularVelocity());
+        phase.push_back(autopilot.currentPhase());
+
+        density.push_back(0.0);
+        gravity.push_back(0.0);
+        active.push_back(1.0);
+        minDistance.push_back(from.minDistance);
+        lastDistance.push_back(from.lastDistance);
+        wasClose.push_back(from.wasClose ? 1 : 0);
+        recedingSteps.push_back(static_cast<std::uint32_t>(from.recedingSteps));
+        pruningPeak.push_back(from.pruningPeak);
+        id.push_back(rocketId);
+    }
+
+    void RocketBatch::pad()
+    {
+        while (lanes() % batch::MAX_WIDTH != 0)
+        {
+            forEachColumn([](auto &column)
+                          { auto value = column.back(); column.push_back(value); });
+            active.back() = 0.0;
+        }
+    }
+
+    void RocketBatch::compact()
+    {
+        std::vector<std::size_t> running;
+        for (std::size_t lane = 0; lane < lanes(); ++lane)
+        {
+            if (active[lane] > 0.0)
+            {
+                running.push_back(lane);
+            }
+        }
+
+        forEachColumn([&running](auto &column)
+                      {
+                          for (std::size_t k = 0; k < running.size(); ++k)
+                          {
+                              column[k] = column[running[k]];
+                          }
+                          column.resize(running.size()); });
+        pad();
+    }
+
+    batch::LaneArrays RocketBatch::arrays()
+    {
+        return {
+            px.data(), py.data(), pz.data(),
+            vx.data(), vy.data(), vz.data(),
+            tx.data(), ty.data(), tz.data(),
+            dryMass.data(),
+            fuelMass.data(),
+            thrust.data(),
+            thrustLevel.data(),
+            exhaustVelocity.data(),
+            dragCoefficient.data(),
+            area.data(),
+            density.data(),
+            gravity.data(),
+            active.data(),
+            lanes()};
+    }
+
+    BatchSimulator::BatchSimulator(std::shared_ptr<Environment> env, const Vector3 &destination)
+        : environment_(env), destination_(destination)
+    {
+        if (!environment_)
+        {
+            throw std::runtime_error("BatchSimulator needs an environment");
+        }
+        integrate_ = batch::selectIntegrator(&backend_);
+    }
+
+    std::size_t BatchSimulator::add(const Rocket &rocket, const GravityTurnAutopilot &autopilot)
+    {
+        // Simulator's constructor puts every rocket on the launch pad
+        Simulator::Snapshot launch{rocket, {}};
+        launch.rocket.setPosition(Vector3(0, config::EARTH_RADIUS + 1.0, 0));
+        return add(launch, autopilot);
+    }
+
+    std::size_t BatchSimulator::add(const Simulator::Snapshot &from, const GravityTurnAutopilot &autopilot)
+    {
+        Vector3 offset = autopilot.destination() - destination_;
+        if (offset.length() > 1e-6)
+        {
+            throw std::invalid_argument("BatchSimulator: autopilot flies to a different destination");
+        }
+
+        if (results_.empty())
+        {
+            startTime_ = from.time;
+            startSteps_ = from.stepCount;
+        }
+        else if (from.time != startTime_ || from.stepCount != startSteps_)
+        {
+            throw std::invalid_argument("BatchSimulator: rockets start at different times");
+        }
+
+        std::size_t index = results_.size();
+        results_.emplace_back();
+        pruningBounds_.push_back(std::numeric_limits<double>::infinity());
+        batch_.push(index, from, autopilot);
+        return index;
+    }
+
+    std::size_t BatchSimulator::size() const
+    {
+        return results_.size();
+    }
+
+    void BatchSimulator::setPruningBound(double bound)
+    {
+        pruningBounds_.assign(pruningBounds_.size(), bound);
+    }
+
+    void BatchSimulator::setPruningBound(std::size_t index, double bound)
+    {
+        pruningBounds_.at(index) = bound;
+    }
+
+    void BatchSimulator::setRecedingPruning(bool enabled)
+    {
+        recedingPruning_ = enabled;
+    }
+
+    const BatchResult &BatchSimulator::result(std::size_t index) const
+    {
+        return results_.at(index);
+    }
+
+    const char *BatchSimulator::simdBackend() const
+    {
+        return backend_;
+    }
+
+    void BatchSimulator::run(double dt)
+    {
+        batch_.pad();
+
+        std::size_t running = 0;
+        for (std::size_t lane = 0; lane < batch_.lanes(); ++lane)
+        {
+            running += batch_.active[lane] > 0.0 ? 1 : 0;
+        }
+
+        time_ = startTime_;
+        steps_ = startSteps_;
+        std::size_t steps = startSteps_;
+
+        while (running > 0)
+        {
+            ++steps;
+
+            for (std::size_t lane = 0; lane < batch_.lanes(); ++lane)
+            {
+                if (batch_.active[lane] <= 0.0)
+                {
+                    continue;
+                }
+
+                if (checkTermination(lane, steps, dt))
+                {
+                    --running;
+                    continue;
+                }
+
+                guide(lane, dt);
+
+                double r = Vector3(batch_.px[lane], batch_.py[lane], batch_.pz[lane]).length();
+                double altitude = std::max(r - config::EARTH_RADIUS, 0.0);
+                batch_.density[lane] = environment_->getAtmosphericDensity(altitude);
+                batch_.gravity[lane] = environment_->getGravity(altitude);
+            }
+
+            if (running == 0)
+            {
+                break;
+            }
+
+            integrate_(batch_.arrays(), dt);
+            time_ += dt;
+            ++steps_;
+
+            // Keep finished lanes from occupying SIMD width
+            if (running * 2 <= batch_.lanes() && batch_.lanes() > batch::MAX_WIDTH)
+            {
+                batch_.compact();
+            }
+        }
+    }
+
+    bool BatchSimulator::checkTermination(std::size_t lane, std::size_t steps, double dt)
+    {
+        RocketBatch &b = batch_;
+
+        // Same checks in the same order as Simulator::run
+        if (time_ >= Simulator::MAX_SIMULATION_TIME)
+        {
+            finish(lane, TerminationReason::TimeLimit);
+            return true;
+        }
+        if (b.fuelMass[lane] <= 0)
+        {
+            finish(lane, TerminationReason::OutOfFuel);
+            return true;
+        }
+
+        constexpr double tolerance = 1500.0;
+        Vector3 position(b.px[lane], b.py[lane], b.pz[lane]);
+        double distance = (position - destination_).length();
+        if (distance < b.minDistance[lane])
+        {
+            b.minDistance[lane] = distance;
+        }
+        if (distance < 2.0 * tolerance)
+        {
+            b.wasClose[lane] = 1;
+        }
+        if (b.wasClose[lane] && distance > b.minDistance[lane] && b.minDistance[lane] <= tolerance)
+        {
+            finish(lane, TerminationReason::Arrived);
+            return true;
+        }
+
+        double pruningBound = pruningBounds_[b.id[lane]];
+        if (pruningBound == std::numeric_limits<double>::infinity())
+        {
+            return false;
+        }
+
+        Vector3 velocity(b.vx[lane], b.vy[lane], b.vz[lane]);
+
+        if (recedingPruning_ && b.phase[lane] == Phase::TargetApproach)
+        {
+            bool receding = distance > b.lastDistance[lane] &&
+                            (position - destination_).dot(velocity) > 0.0;
+            b.recedingSteps[lane] = receding ? b.recedingSteps[lane] + 1 : 0;
+            b.lastDistance[lane] = distance;
+
+            if (b.recedingSteps[lane] >= Simulator::RECEDING_STEPS_TO_PRUNE)
+            {
+                if (distance > pruningBound)
+                {
+                    results_[b.id[lane]].prunedDistance = distance;
+                    finish(lane, TerminationReason::Pruned);
+                    return true;
+                }
+                b.pruningPeak[lane] = std::max(b.pruningPeak[lane], distance);
+            }
+        }
+
+        if (steps % Simulator::PRUNING_CHECK_INTERVAL == 0)
+        {
+            double bound = distanceLowerBound(distance, velocity.length(),
+                                              b.fuelMass[lane], b.dryMass[lane] + b.fuelMass[lane],
+                                              b.burnRate[lane], b.exhaustVelocity[lane],
+                                              1.0, Simulator::MAX_SIMULATION_TIME - time_, dt);
+            if (bound > pruningBound)
+            {
+                results_[b.id[lane]].prunedDistance = bound;
+                finish(lane, TerminationReason::Pruned);
+                return true;
+            }
+            b.pruningPeak[lane] = std::max(b.pruningPeak[lane], bound);
+        }
+
+        return false;
+    }
+
+    void BatchSimulator::finish(std::size_t lane, TerminationReason reason)
+    {
+        RocketBatch &b = batch_;
+        BatchResult &result = results_[b.id[lane]];
+
+        result.state = {
+            Vector3(b.px[lane], b.py[lane], b.pz[lane]),
+            Vector3(b.vx[lane], b.vy[lane], b.vz[lane]),
+            Vector3(b.tx[lane], b.ty[lane], b.tz[lane]),
+            b.fuelMass[lane],
+            b.thrustLevel[lane],
+            b.dryMass[lane] + b.fuelMass[lane]};
+        result.reason = reason;
+        result.time = time_;
+        result.steps = steps_;
+        result.minDistance = b.minDistance[lane];
+        // Without a bound the checks never ran
+        double pruningBound = pruningBounds_[b.id[lane]];
+        result.pruningPeak = pruningBound == std::numeric_limits<double>::infinity()
+                                 ? pruningBound
+                                 : b.pruningPeak[lane];
+
+        b.active[lane] = 0.0;
+    }
+
+    void BatchSimulator::setThrust(std::size_t lane, const Vector3 &desiredDirection, double maxAnglePerStep)
+    {
+        RocketBatch &b = batch_;
+
+        // Rocket::setThrust
+        Vector3 current(b.tx[lane], b.ty[lane], b.tz[lane]);
+        Vector3 desired = desiredDirection.normalized();
+        Vector3 direction = desired;
+
+        double angle = Vector3::angle(current, desired);
+        if (angle >= 1e-5)
+        {
+            double t = std::min(1.0, maxAnglePerStep / angle);
+            direction = (current + (desired - current) * t).normalized();
+        }
+
+        b.tx[lane] = direction.x();
+        b.ty[lane] = direction.y();
+        b.tz[lane] = direction.z();
+    }
+
+    void BatchSimulator::setThrustLevel(std::size_t lane, double level)
+    {
+        RocketBatch &b = batch_;
+
+        // Rocket::setThrustLevel
+        if (b.fuelMass[lane] <= 0)
+        {
+            b.thrust[lane] = 0;
+            b.thrustLevel[lane] = 0;
+            return;
+        }
+        b.thrustLevel[lane] = std::clamp(level, 0.0, 1.0);
+        b.thrust[lane] = b.thrustLevel[lane] * b.specificImpulse[lane] * config::g * b.burnRate[lane];
+    }
+
+    void BatchSimulator::guide(std::size_t lane, double dt)
+    {
+        RocketBatch &b = batch_;
+
+        // GravityTurnAutopilot::update, without the logging
+        if (b.fuelMass[lane] <= 0)
+        {
+            setThrustLevel(lane, 0.0);
+            b.phase[lane] = Phase::TargetApproach;
+            return;
+        }
+
+        Vector3 position(b.px[lane], b.py[lane], b.pz[lane]);
+        Vector3 velocity(b.vx[lane], b.vy[lane], b.vz[lane]);
+        Vector3 thrustDirection = (Vector3(b.tx[lane], b.ty[lane], b.tz[lane]) * b.thrust[lane]).normalized();
+        double maxAngle = b.maxAngularVelocity[lane] * dt;
+        double targetAltitude = b.targetAltitude[lane];
+
+        double altitude = position.length() - config::EARTH_RADIUS;
+        if (altitude < 0 && b.phase[lane] != Phase::TargetApproach)
+        {
+            altitude = 0;
+        }
+
+        Vector3 toTarget = (destination_ - position).normalized();
+
+        if (b.phase[lane] == Phase::VerticalAscent)
+        {
+            if (altitude >= targetAltitude * 0.5)
+            {
+                b.phase[lane] = Phase::GravityTurn;
+            }
+            else
+            {
+                setThrust(lane, position.normalized(), maxAngle);
+                setThrustLevel(lane, 1.0);
+                return;
+            }
+        }
+
+        if (b.phase[lane] == Phase::GravityTurn)
+        {
+            // GravityTurnAutopilot::calculateOptimalTurnDirection
+            Vector3 velocityDir = velocity.normalized();
+            Vector3 positionDir = position.normalized();
+
+            Vector3 toTargetHorizontal = toTarget - positionDir * toTarget.dot(positionDir);
+            if (toTargetHorizontal.length() < 1e-5)
+            {
+                toTargetHorizontal = velocityDir;
+            }
+            toTargetHorizontal = toTargetHorizontal.normalized();
+
+            double turnStart = b.turnStartAltitude[lane];
+            double trueAltitude = position.length() - config::EARTH_RADIUS;
+            double turnProgress = std::clamp((trueAltitude - turnStart) / (targetAltitude - turnStart), 0.0, 1.0);
+
+            Vector3 desiredDirection = Vector3::slerp(positionDir, toTargetHorizontal, turnProgress);
+
+            double gravity = environment_->getGravity(std::max(trueAltitude, 0.0));
+            double mass = b.dryMass[lane] + b.fuelMass[lane];
+            Vector3 gravityDir = (positionDir * (-gravity * mass)).normalized();
+            desiredDirection = (desiredDirection - gravityDir * (1.0 - turnProgress)).normalized();
+
+            double currentAngle = Vector3::angle(thrustDirection, desiredDirection);
+
+            setThrust(lane, desiredDirection, maxAngle);
+            setThrustLevel(lane, 1.0);
+
+            if (currentAngle < .5 && altitude > targetAltitude * 0.7)
+            {
+                b.phase[lane] = Phase::TargetApproach;
+            }
+            return;
+        }
+
+        double distanceToTarget = (destination_ - position).length();
+        if (distanceToTarget < 1500.0)
+        {
+            return;
+        }
+
+        double currentAngle = Vector3::angle(thrustDirection, toTarget);
+        double angleChange = std::min(currentAngle, maxAngle);
+
+        if (currentAngle > 0.0)
+        {
+            double t = angleChange / currentAngle;
+            Vector3 newDirection = thrustDirection + (toTarget - thrustDirection) * t;
+            setThrust(lane, newDirection.normalized(), maxAngle);
+        }
+        else
+        {
+            setThrust(lane, toTarget, maxAngle);
+        }
+    }
+
+} // namespace sim::core
@@ -1,11 +1,14 @@
 #ifdef USE_EMSCRIPTEN
 #include <emscripten/bind.h>
+#include <emscripten/val.h>
 #include "../../include/core/optimizer.hpp"
+#include "../../include/core/multi_destination_optimizer.hpp"
 #include "../../include/core/simulator.hpp"
 #include "../../include/core/vector3.hpp"
 #include "../../include/core/autopilot.hpp"
 #include "../../include/core/environment.hpp"
 #include "../../include/utils/logger.hpp"
+#include <chrono>
 #include <memory>
 
 using namespace emscripten;
@@ -48,6 +51,84 @@ namespace
         return std::make_shared<sim::core::Simulator>(rocket, env, destination, autopilot);
     }
 
+    // Float32Array over the samples of the last stepMany(), VISUAL_SAMPLE_FLOATS per
+    // sample. It aliases the WASM heap without copying and is invalidated by the next
+    // stepMany() or when the heap grows, so fetch it again after every call.
+    val simulatorSamples(const sim::core::Simulator &simulator)
+    {
+        return val(typed_memory_view(simulator.sampleCount() * sim::core::Simulator::VISUAL_SAMPLE_FLOATS,
+                                     reinterpret_cast<const float *>(simulator.samples())));
+    }
+
+    // Searches for `milliseconds`, calling onProgress (if not undefined) after every
+    // batch with {evaluations, elapsedSeconds, bestScore, bestParameters}. Returning
+    // false from onProgress stops the search.
+    void optimizeFor(sim::core::Optimizer &optimizer, double milliseconds, val onProgress)
+    {
+        sim::utils::CancellationToken cancel;
+        sim::core::Optimizer::ProgressCallback progress;
+        if (!onProgress.isUndefined() && !onProgress.isNull())
+        {
+            progress = [&](const sim::core::Optimizer::Progress &p)
+            {
+                val params = val::object();
+                params.set("dryMass", p.bestParameters.dryMass);
+                params.set("initialFuel", p.bestParameters.initialFuel);
+                params.set("burnRate", p.bestParameters.burnRate);
+                params.set("specificImpulse", p.bestParameters.specificImpulse);
+                params.set("turnStartAltitude", p.bestParameters.turnStartAltitude);
+                params.set("turnRate", p.bestParameters.turnRate);
+
+                val report = val::object();
+                report.set("evaluations", static_cast<double>(p.evaluations));
+                report.set("elapsedSeconds", p.elapsedSeconds);
+                report.set("bestScore", p.bestScore);
+                report.set("bestParameters", params);
+                if (onProgress(report).strictlyEquals(val(false)))
+                {
+                    cancel.cancel();
+                }
+            };
+        }
+        optimizer.optimizeFor(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                  std::chrono::duration<double, std::milli>(milliseconds)),
+                              progress, &cancel);
+    }
+
+    // Optimizes for every {x, y, z} of the array on all threads and returns one
+    // Optimizer.toJson string per destination, in order
+    val optimizeDestinations(val destinations, int iterations)
+    {
+        std::vector<sim::core::Vector3> targets;
+        unsigned length = destinations["length"].as<unsigned>();
+        targets.reserve(length);
+        for (unsigned i = 0; i < length; ++i)
+        {
+            val d = destinations[i];
+            targets.emplace_back(d["x"].as<double>(), d["y"].as<double>(), d["z"].as<double>());
+        }
+
+        sim::core::MultiDestinationOptimizer optimizer(createEnvironment());
+        auto results = optimizer.optimize(targets, iterations);
+
+        val records = val::array();
+        for (const auto &result : results)
+        {
+            records.call<void>("push", result.json);
+        }
+        return records;
+    }
+
+    // Whether this is the pthreads build; Optimizer.setThreadCount(0) then uses every core
+    bool threadsSupported()
+    {
+#ifdef __EMSCRIPTEN_PTHREADS__
+        return true;
+#else
+        return false;
+#endif
+    }
+
     std::shared_ptr<sim::core::Rocket> createRocket(
         double dryMass,
         double fuelMass,
@@ -74,11 +155,19 @@ EMSCRIPTEN_BINDINGS(simulator)
         .function("multiplyScalar", &sim::core::Vector3::operator*);
 
     // Environment binding
+    enum_<sim::core::EnvironmentModel>("EnvironmentModel")
+        .value("Analytic", sim::core::EnvironmentModel::Analytic)
+        .value("TabulatedExponential", sim::core::EnvironmentModel::TabulatedExponential)
+        .value("StandardAtmosphere1976", sim::core::EnvironmentModel::StandardAtmosphere1976);
+
     class_<sim::core::Environment>("Environment")
         .smart_ptr<std::shared_ptr<sim::core::Environment>>("shared_ptr<Environment>")
         .constructor<>()
-        .function("computeGravityForce", &sim::core::Environment::computeGravityForce)
-        .function("computeDragForce", &sim::core::Environment::computeDragForce);
+        .constructor<sim::core::EnvironmentModel>()
+        .function("computeGravityForce",
+                  select_overload<sim::core::Vector3(const sim::core::Rocket &) const>(&sim::core::Environment::computeGravityForce))
+        .function("computeDragForce",
+                  select_overload<sim::core::Vector3(const sim::core::Rocket &) const>(&sim::core::Environment::computeDragForce));
 
     // Rocket binding
     class_<sim::core::Rocket>("Rocket")
@@ -122,25 +211,50 @@ EMSCRIPTEN_BINDINGS(simulator)
     class_<sim::core::Optimizer>("Optimizer")
         .smart_ptr<std::shared_ptr<sim::core::Optimizer>>("shared_ptr<Optimizer>")
         .constructor<std::shared_ptr<sim::core::Environment>, const sim::core::Vector3 &>()
-        .function("optimize", &sim::core::Optimizer::optimize)
+        .function("optimize", select_overload<void(int)>(&sim::core::Optimizer::optimize))
+        .function("optimizeFor", &optimizeFor)
         .function("getBestRocket", &sim::core::Optimizer::getBestRocket)
-        .function("getBestAutopilot", &sim::core::Optimizer::getBestAutopilot);
+        .function("getBestAutopilot", &sim::core::Optimizer::getBestAutopilot)
+        .function("getBestScore", &sim::core::Optimizer::getBestScore)
+        .function("setThreadCount", &sim::core::Optimizer::setThreadCount)
+        .function("threadCount", &sim::core::Optimizer::threadCount)
+        .function("setMetricsEnabled", &sim::core::Optimizer::setMetricsEnabled)
+        .function("metricsJson", &sim::core::Optimizer::metricsJson);
 
     // Simulator binding
-    class_<sim::core::Simulator>("Simulator")
+    enum_<sim::core::Simulator::TerminationReason>("TerminationReason")
+        .value("None", sim::core::Simulator::TerminationReason::None)
+        .value("OutOfFuel", sim::core::Simulator::TerminationReason::OutOfFuel)
+        .value("Arrived", sim::core::Simulator::TerminationReason::Arrived)
+        .value("TimeLimit", sim::core::Simulator::TerminationReason::TimeLimit)
+        .value("Pruned", sim::core::Simulator::TerminationReason::Pruned)
+        .value("GroundContact", sim::core::Simulator::TerminationReason::GroundContact)
+        .value("ClosestApproach", sim::core::Simulator::TerminationReason::ClosestApproach);
+
+    // Simulator inherits most of its methods; embind wants them bound on the class
+    // that declares them
+    class_<sim::core::SimulatorBase>("SimulatorBase")
+        .function("terminationReason", &sim::core::SimulatorBase::terminationReason)
+        .function("destination", &sim::core::SimulatorBase::destination);
+
+    class_<sim::core::DynamicSimulator, base<sim::core::SimulatorBase>>("DynamicSimulator")
+        .function("step", &sim::core::DynamicSimulator::step)
+        .function("run", select_overload<void(double)>(&sim::core::DynamicSimulator::run))
+        .function("rocket", &sim::core::DynamicSimulator::rocket)
+        .function("environment", &sim::core::DynamicSimulator::environment)
+        .function("isArrived", &sim::core::DynamicSimulator::isArrived)
+        .function("getCurrentDistance", &sim::core::DynamicSimulator::getCurrentDistance)
+        .function("reset", &sim::core::DynamicSimulator::reset);
+
+    class_<sim::core::Simulator, base<sim::core::DynamicSimulator>>("Simulator")
         .constructor<std::shared_ptr<sim::core::Rocket>, std::shared_ptr<sim::core::Environment>, sim::core::Vector3, std::shared_ptr<sim::core::Autopilot>>()
         .smart_ptr<std::shared_ptr<sim::core::Simulator>>("shared_ptr<Simulator>")
-        .function("step", &sim::core::Simulator::step)
-        .function("run", &sim::core::Simulator::run)
-        .function("rocket", &sim::core::Simulator::rocket)
+        .function("stepMany", &sim::core::Simulator::stepMany)
+        .function("sampleCount", &sim::core::Simulator::sampleCount)
+        .function("samples", &simulatorSamples)
         .function("physicsToVisual", &sim::core::Simulator::physicsToVisual)
         .function("getVisualState", &sim::core::Simulator::getVisualState)
-        .function("environment", &sim::core::Simulator::environment)
-        .function("destination", &sim::core::Simulator::destination)
-        .function("isArrived", &sim::core::Simulator::isArrived)
-        .function("getCurrentDistance", &sim::core::Simulator::getCurrentDistance)
-        .function("isOutOfFuel", &sim::core::Rocket::isOutOfFuel)
-        .function("reset", &sim::core::Simulator::reset);
+        .function("isOutOfFuel", &sim::core::Rocket::isOutOfFuel);
 
     // Logger binding
     enum_<sim::utils::LogLevel>("LogLevel")
@@ -152,20 +266,23 @@ EMSCRIPTEN_BINDINGS(simulator)
 
     class_<sim::utils::Logger>("Logger")
         .class_function("setLevel", &sim::utils::Logger::setLevel)
-        .class_function("debug", &sim::utils::Logger::debug)
-        .class_function("info", &sim::utils::Logger::info)
-        .class_function("warning", &sim::utils::Logger::warning)
-        .class_function("error", &sim::utils::Logger::error);
+        .class_function("debug", select_overload<void(const std::string &)>(&sim::utils::Logger::debug))
+        .class_function("info", select_overload<void(const std::string &)>(&sim::utils::Logger::info))
+        .class_function("warning", select_overload<void(const std::string &)>(&sim::utils::Logger::warning))
+        .class_function("error", select_overload<void(const std::string &)>(&sim::utils::Logger::error));
 
     // Constants
     constant("PHYSICS_TO_VISUAL_SCALE", sim::utils::config::PHYSICS_TO_VISUAL_SCALE);
     constant("VISUAL_TO_PHYSICS_SCALE", sim::utils::config::VISUAL_TO_PHYSICS_SCALE);
     constant("VISUAL_EARTH_RADIUS", sim::utils::config::VISUAL_EARTH_RADIUS);
     constant("EARTH_RADIUS", sim::utils::config::EARTH_RADIUS);
+    constant("VISUAL_SAMPLE_FLOATS", sim::core::Simulator::VISUAL_SAMPLE_FLOATS);
 
     // Helper functions
     function("createEnvironment", &createEnvironment);
     function("createOptimizer", &createOptimizer);
+    function("threadsSupported", &threadsSupported);
+    function("optimizeDestinations", &optimizeDestinations);
     function("createSimulator", &createSimulator);
     function("createGravityTurnAutopilot", &createGravityTurnAutopilot);
     function("createRocket", &createRocket);
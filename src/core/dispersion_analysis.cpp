@@ -0,0 +1,302 @@
+#include "../../include/core/dispersion_analysis.hpp"
+#include "../../include/utils/random.hpp"
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+using sim::utils::CounterRng;
+using sim::utils::ThreadPool;
+
+namespace sim::core
+{
+
+    namespace
+    {
+        constexpr double CUTOFF = 3.0; // standard deviations
+
+        // Chunks per thread and round; each holds its own Results until the round
+        // is folded in
+        constexpr std::size_t CHUNKS_PER_THREAD = 4;
+
+        void writeNumber(std::ostringstream &out, double value)
+        {
+            if (std::isfinite(value))
+            {
+                out << value;
+            }
+            else
+            {
+                out << "null";
+            }
+        }
+
+        void writeDistribution(std::ostringstream &out, const DispersionAnalysis::Distribution &distribution)
+        {
+            constexpr std::pair<const char *, double> QUANTILES[] = {
+                {"p01", 0.01}, {"p05", 0.05}, {"p50", 0.5}, {"p95", 0.95}, {"p99", 0.99}};
+
+            const auto &stats = distribution.stats;
+            bool empty = stats.count() == 0;
+            out << "{\"mean\":";
+            writeNumber(out, empty ? NAN : stats.mean());
+            out << ",\"standardDeviation\":";
+            writeNumber(out, empty ? NAN : stats.standardDeviation());
+            out << ",\"min\":";
+            writeNumber(out, stats.min());
+            out << ",\"max\":";
+            writeNumber(out, stats.max());
+            for (const auto &[name, q] : QUANTILES)
+            {
+                out << ",\"" << name << "\":";
+                writeNumber(out, distribution.quantiles.quantile(q));
+            }
+            out << '}';
+        }
+    }
+
+    void DispersionAnalysis::Distribution::add(double value)
+    {
+        stats.add(value);
+        quantiles.add(value);
+    }
+
+    void DispersionAnalysis::Distribution::merge(const Distribution &other)
+    {
+        stats.merge(other.stats);
+        quantiles.merge(other.quantiles);
+    }
+
+    void DispersionAnalysis::Results::merge(const Results &other)
+    {
+        runs += other.runs;
+        missDistance.merge(other.missDistance);
+        fuelLeft.merge(other.fuelLeft);
+        flightTime.merge(other.flightTime);
+        for (std::size_t i = 0; i < terminations.size(); ++i)
+        {
+            terminations[i] += other.terminations[i];
+        }
+    }
+
+    std::string DispersionAnalysis::Results::toJson() const
+    {
+        std::ostringstream out;
+        out << "{\"runs\":" << runs << ",\"missDistance\":";
+        writeDistribution(out, missDistance);
+        out << ",\"fuelLeft\":";
+        writeDistribution(out, fuelLeft);
+        out << ",\"flightTime\":";
+        writeDistribution(out, flightTime);
+        out << ",\"terminations\":{";
+        for (std::size_t i = 0; i < terminations.size(); ++i)
+        {
+            out << (i ? "," : "") << '"' << terminationReasonName(i) << "\":" << terminations[i];
+        }
+        out << "}}";
+        return out.str();
+    }
+
+    DispersionAnalysis::DispersionAnalysis(std::shared_ptr<Environment> env, const Vector3 &destination,
+                                           const Rocket &nominal, std::shared_ptr<const Autopilot> autopilot,
+                                           std::uint64_t seed)
+        : env_(std::move(env)), destination_(destination), nominal_(nominal),
+          autopilot_(std::move(autopilot)), seed_(seed)
+    {
+        if (!env_)
+        {
+            throw std::invalid_argument("DispersionAnalysis needs an environment");
+        }
+        if (!autopilot_ || !autopilot_->clone())
+        {
+            throw std::invalid_argument("DispersionAnalysis needs an autopilot that can be cloned");
+        }
+    }
+
+    void DispersionAnalysis::setDispersions(const Dispersions &dispersions)
+    {
+        // Relative factors stay positive within the cutoff
+        for (double relative : {dispersions.dryMass, dispersions.specificImpulse,
+                                dispersions.dragCoefficient, dispersions.atmosphericDensity})
+        {
+            if (!(relative >= 0.0 && relative * CUTOFF < 1.0))
+            {
+                throw std::invalid_argument("DispersionAnalysis: relative dispersions must be in [0, 1/3)");
+            }
+        }
+        if (!(dispersions.launchPosition >= 0.0 && dispersions.launchVelocity >= 0.0))
+        {
+            throw std::invalid_argument("DispersionAnalysis: dispersions must not be negative");
+        }
+        dispersions_ = dispersions;
+    }
+
+    const DispersionAnalysis::Dispersions &DispersionAnalysis::dispersions() const
+    {
+        return dispersions_;
+    }
+
+    void DispersionAnalysis::setSeed(std::uint64_t seed)
+    {
+        seed_ = seed;
+    }
+
+    std::uint64_t DispersionAnalysis::seed() const
+    {
+        return seed_;
+    }
+
+    void DispersionAnalysis::setTimeStep(double dt)
+    {
+        if (!(dt > 0.0))
+        {
+            throw std::invalid_argument("DispersionAnalysis time step must be positive");
+        }
+        timeStep_ = dt;
+    }
+
+    double DispersionAnalysis::timeStep() const
+    {
+        return timeStep_;
+    }
+
+    void DispersionAnalysis::setThreadCount(unsigned threads)
+    {
+        if (threads == 0)
+        {
+            threads = static_cast<unsigned>(ThreadPool::defaultThreadCount());
+        }
+
+        if (threads != threadCount_)
+        {
+            threadCount_ = threads;
+            pool_.reset();
+        }
+    }
+
+    unsigned DispersionAnalysis::threadCount() const
+    {
+        return threadCount_;
+    }
+
+    void DispersionAnalysis::setThreadPool(std::shared_ptr<ThreadPool> pool)
+    {
+        if (!pool)
+        {
+            throw std::invalid_argument("DispersionAnalysis::setThreadPool: null pool");
+        }
+        threadCount_ = static_cast<unsigned>(pool->size());
+        pool_ = std::move(pool);
+    }
+
+    DispersionAnalysis::Perturbation DispersionAnalysis::perturbation(std::uint64_t run) const
+    {
+        CounterRng rng(seed_, run);
+        auto draw = [&rng](double sigma)
+        {
+            return sigma * std::clamp(rng.normal(), -CUTOFF, CUTOFF);
+        };
+
+        // Always the same number of draws in the same order, whatever is switched off
+        Perturbation p;
+        p.dryMassFactor = 1.0 + draw(dispersions_.dryMass);
+        p.specificImpulseFactor = 1.0 + draw(dispersions_.specificImpulse);
+        p.dragCoefficientFactor = 1.0 + draw(dispersions_.dragCoefficient);
+        p.densityFactor = 1.0 + draw(dispersions_.atmosphericDensity);
+        double east = draw(dispersions_.launchPosition);
+        double north = draw(dispersions_.launchPosition);
+        p.launchOffset = Vector3(east, 0.0, north);
+        double vx = draw(dispersions_.launchVelocity);
+        double vy = draw(dispersions_.launchVelocity);
+        double vz = draw(dispersions_.launchVelocity);
+        p.launchVelocity = Vector3(vx, vy, vz);
+        return p;
+    }
+
+    std::unique_ptr<Simulator> DispersionAnalysis::createSimulator(std::uint64_t run) const
+    {
+        Perturbation p = perturbation(run);
+
+        auto rocket = std::make_shared<Rocket>(nominal_.dryMass() * p.dryMassFactor,
+                                               nominal_.fuelMass(),
+                                               nominal_.burnRate(),
+                                               nominal_.specificImpulse() * p.specificImpulseFactor,
+                                               nominal_.getCrossSectionArea(),
+                                               nominal_.getDragCoefficient() * p.dragCoefficientFactor);
+        rocket->setPosition(nominal_.position() + p.launchOffset);
+        rocket->setVelocity(nominal_.velocity() + p.launchVelocity);
+
+        auto env = std::make_shared<Environment>(env_->model());
+        env->setDensityScale(env_->densityScale() * p.densityFactor);
+
+        return std::make_unique<Simulator>(rocket, env, destination_, autopilot_->clone());
+    }
+
+    void DispersionAnalysis::fly(std::uint64_t run, Results &results) const
+    {
+        auto sim = createSimulator(run);
+        sim->run(timeStep_);
+
+        const Rocket &rocket = sim->rocket();
+        ++results.runs;
+        results.missDistance.add((rocket.position() - destination_).length());
+        results.fuelLeft.add(rocket.fuelMass());
+        results.flightTime.add(sim->time());
+        ++results.terminations[static_cast<std::size_t>(sim->terminationReason())];
+    }
+
+    DispersionAnalysis::Results DispersionAnalysis::run(std::uint64_t runs, const ProgressCallback &progress,
+                                                        const sim::utils::CancellationToken *cancel)
+    {
+        if (!pool_)
+        {
+            pool_ = std::make_shared<ThreadPool>(threadCount_);
+        }
+
+        Results total;
+        std::uint64_t chunks = (runs + RUNS_PER_CHUNK - 1) / RUNS_PER_CHUNK;
+        std::size_t chunksPerRound = CHUNKS_PER_THREAD * pool_->size();
+        std::vector<Results> partial(chunksPerRound);
+        std::vector<char> finished(chunksPerRound);
+
+        for (std::uint64_t firstChunk = 0; firstChunk < chunks; firstChunk += chunksPerRound)
+        {
+            auto count = static_cast<std::size_t>(std::min<std::uint64_t>(chunksPerRound, chunks - firstChunk));
+
+            auto flyChunk = [&](std::size_t i)
+            {
+                partial[i] = Results();
+                finished[i] = 0;
+                std::uint64_t begin = (firstChunk + i) * RUNS_PER_CHUNK;
+                std::uint64_t end = std::min<std::uint64_t>(begin + RUNS_PER_CHUNK, runs);
+                for (std::uint64_t run = begin; run < end; ++run)
+                {
+                    if (cancel && cancel->isCancelled())
+                    {
+                        return;
+                    }
+                    fly(run, partial[i]);
+                }
+                finished[i] = 1;
+            };
+            pool_->parallelFor(count, flyChunk);
+
+            // In chunk order, so the sums are the same on any number of threads
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                if (!finished[i])
+                {
+                    return total;
+                }
+                total.merge(partial[i]);
+            }
+            if (progress)
+            {
+                progress(total);
+            }
+        }
+        return total;
+    }
+
+} // namespace sim::core
@@ -1,31 +1,98 @@
 #include "../../include/core/environment.hpp"
 #include "../../include/physics/gravity.hpp"
 #include "../../include/physics/aerodynamics.hpp"
+#include "../../include/physics/hermite_table.hpp"
+#include "../../include/utils/config.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+using sim::utils::config::ATMOSPHERE_HEIGHT;
+
 namespace sim::core
 {
 
-    double Environment::getGravity(double alt) const
+    namespace
+    {
+        constexpr double DENSITY_SPACING = 250.0; // m
+
+        const sim::physics::HermiteTable &exponentialDensityTable()
+        {
+            static const sim::physics::HermiteTable table(
+                0.0, ATMOSPHERE_HEIGHT, DENSITY_SPACING,
+                [](double altitude)
+                { return sim::aerodynamics::computeAtmosphericDensity(altitude); },
+                [](double altitude)
+                { return -sim::aerodynamics::computeAtmosphericDensity(altitude) / sim::utils::config::SCALE_HEIGHT; });
+            return table;
+        }
+
+        const sim::physics::HermiteTable &standardDensityTable()
+        {
+            // The layer formulas have no closed-form slope at the layer boundaries;
+            // central differences over a metre are accurate enough for the nodes
+            static const sim::physics::HermiteTable table(
+                0.0, ATMOSPHERE_HEIGHT, DENSITY_SPACING,
+                [](double altitude)
+                { return sim::aerodynamics::computeStandardAtmosphereDensity(altitude); },
+                [](double altitude)
+                {
+                    double lo = std::max(altitude - 0.5, 0.0);
+                    double hi = altitude + 0.5;
+                    return (sim::aerodynamics::computeStandardAtmosphereDensity(hi) -
+                            sim::aerodynamics::computeStandardAtmosphereDensity(lo)) /
+                           (hi - lo);
+                });
+            return table;
+        }
+    }
+
+    Environment::Environment(EnvironmentModel model)
+        : model_(model)
+    {
+        // Resolve (and build) the tables once rather than on every lookup
+        switch (model_)
+        {
+        case EnvironmentModel::TabulatedExponential:
+            densityTable_ = &exponentialDensityTable();
+            break;
+        case EnvironmentModel::StandardAtmosphere1976:
+            densityTable_ = &standardDensityTable();
+            break;
+        case EnvironmentModel::Analytic:
+            break;
+        }
+    }
+
+    EnvironmentModel Environment::model() const
+    {
+        return model_;
+    }
+
+    void Environment::setDensityScale(double scale)
     {
-        return sim::physics::computeGravity(alt);
+        if (!(scale >= 0.0))
+        {
+            throw std::invalid_argument("Environment density scale must not be negative");
+        }
+        densityScale_ = scale;
     }
 
-    double Environment::getAtmosphericDensity(double alt) const
+    double Environment::densityScale() const
     {
-        return sim::aerodynamics::computeAtmosphericDensity(alt);
+        return densityScale_;
     }
 
     Vector3 Environment::computeGravityForce(const Rocket &rocket) const
     {
-        return sim::physics::computeGravityForce(rocket.position(),
-                                                 rocket.totalMass());
+        return computeGravityForce(rocket.position(), rocket.totalMass());
     }
 
     Vector3 Environment::computeDragForce(const Rocket &rocket) const
     {
-        return sim::aerodynamics::computeDragForce(rocket.position(),
-                                                   rocket.velocity(),
-                                                   rocket.getDragCoefficient(),
-                                                   rocket.getCrossSectionArea());
+        return computeDragForce(rocket.position(),
+                                rocket.velocity(),
+                                rocket.getDragCoefficient(),
+                                rocket.getCrossSectionArea());
     }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,257 @@
+#include "../../include/core/evaluation_cache.hpp"
+#include "../../include/utils/random.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+using sim::utils::hashCombine;
+
+namespace sim::core
+{
+
+    namespace evaluation_cache_format
+    {
+        std::uint64_t checksum(const Record &record)
+        {
+            std::uint64_t score, low, high;
+            std::memcpy(&score, &record.score, sizeof(score));
+            std::memcpy(&low, &record.low, sizeof(low));
+            std::memcpy(&high, &record.high, sizeof(high));
+            return hashCombine(hashCombine(hashCombine(hashCombine(VERSION, record.key), score), low), high);
+        }
+    }
+
+    using namespace evaluation_cache_format;
+
+    namespace
+    {
+        constexpr std::size_t RECORDS_PER_READ = 4096;
+
+        std::uint64_t fileSize(const std::string &path)
+        {
+            std::ifstream in(path, std::ios::binary | std::ios::ate);
+            return in ? static_cast<std::uint64_t>(in.tellg()) : 0;
+        }
+    }
+
+    bool EvaluationCache::BoundRange::contains(double bound) const
+    {
+        return low <= bound && (bound < high || high == std::numeric_limits<double>::infinity());
+    }
+
+    EvaluationCache::KeyBuilder::KeyBuilder()
+        : hash_(hashCombine(VERSION, MODEL_VERSION)) {}
+
+    EvaluationCache::KeyBuilder &EvaluationCache::KeyBuilder::add(std::uint64_t value)
+    {
+        hash_ = hashCombine(hash_, value);
+        return *this;
+    }
+
+    EvaluationCache::KeyBuilder &EvaluationCache::KeyBuilder::add(double value)
+    {
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return add(bits);
+    }
+
+    EvaluationCache::KeyBuilder &EvaluationCache::KeyBuilder::addQuantized(double value)
+    {
+        // Rounds the magnitude to the nearest value with the low mantissa bits clear
+        constexpr int dropped = 52 - QUANTIZATION_BITS;
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        bits = (bits + (std::uint64_t(1) << (dropped - 1))) & ~((std::uint64_t(1) << dropped) - 1);
+        return add(bits);
+    }
+
+    EvaluationCache::EvaluationCache() = default;
+
+    EvaluationCache::EvaluationCache(const std::string &path)
+        : path_(path)
+    {
+        file_ = std::fopen(path.c_str(), "ab");
+        if (!file_)
+        {
+            throw std::runtime_error("Cannot open evaluation cache: " + path);
+        }
+
+        std::uint64_t size = fileSize(path);
+        if (size == 0)
+        {
+            FileHeader header{};
+            std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.version = VERSION;
+            header.byteOrderMark = BYTE_ORDER_MARK;
+            std::fwrite(&header, sizeof(header), 1, file_);
+            std::fflush(file_);
+        }
+        else if (size % RECORD_SIZE != 0)
+        {
+            // A writer died halfway through a record; pad it out so that later records
+            // stay aligned. The padded record fails its checksum and is skipped.
+            std::vector<char> padding(RECORD_SIZE - size % RECORD_SIZE, 0);
+            std::fwrite(padding.data(), 1, padding.size(), file_);
+            std::fflush(file_);
+        }
+
+        FileHeader header{};
+        std::ifstream in(path, std::ios::binary);
+        in.read(reinterpret_cast<char *>(&header), sizeof(header));
+        if (!in || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+        {
+            std::fclose(file_);
+            throw std::runtime_error("Not an evaluation cache: " + path);
+        }
+        if (header.byteOrderMark != BYTE_ORDER_MARK || header.version != VERSION)
+        {
+            std::fclose(file_);
+            throw std::runtime_error("Unsupported evaluation cache version or byte order: " + path);
+        }
+
+        loadedBytes_ = sizeof(FileHeader);
+        load();
+    }
+
+    EvaluationCache::~EvaluationCache()
+    {
+        if (file_)
+        {
+            std::fclose(file_);
+        }
+    }
+
+    EvaluationCache::Shard &EvaluationCache::shardOf(Key key)
+    {
+        return shards_[key >> 60];
+    }
+
+    bool EvaluationCache::insert(Key key, const Entry &entry)
+    {
+        Shard &shard = shardOf(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto [it, inserted] = shard.entries.try_emplace(key, entry);
+        if (!inserted)
+        {
+            constexpr double unbounded = std::numeric_limits<double>::infinity();
+            bool completed = entry.bounds.high == unbounded;
+            bool keptCompleted = it->second.bounds.high == unbounded;
+            if (completed < keptCompleted ||
+                (completed == keptCompleted && it->second.bounds.low <= entry.bounds.low))
+            {
+                return false;
+            }
+            it->second = entry;
+        }
+        return true;
+    }
+
+    std::size_t EvaluationCache::load()
+    {
+        // Only whole records; a partial one at the end is picked up by a later refresh
+        std::uint64_t size = fileSize(path_);
+        std::uint64_t end = size - size % RECORD_SIZE;
+        if (end <= loadedBytes_)
+        {
+            return 0;
+        }
+
+        std::ifstream in(path_, std::ios::binary);
+        in.seekg(static_cast<std::streamoff>(loadedBytes_));
+
+        std::vector<Record> records(RECORDS_PER_READ);
+        std::size_t count = 0;
+        while (loadedBytes_ < end)
+        {
+            std::size_t n = static_cast<std::size_t>(
+                std::min<std::uint64_t>(RECORDS_PER_READ, (end - loadedBytes_) / RECORD_SIZE));
+            if (!in.read(reinterpret_cast<char *>(records.data()), static_cast<std::streamsize>(n * RECORD_SIZE)))
+            {
+                break;
+            }
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                const Record &record = records[i];
+                if (record.checksum == checksum(record))
+                {
+                    insert(record.key, {record.score, {record.low, record.high}});
+                }
+            }
+            loadedBytes_ += n * RECORD_SIZE;
+            count += n;
+        }
+        return count;
+    }
+
+    std::size_t EvaluationCache::refresh()
+    {
+        if (!file_)
+        {
+            return 0;
+        }
+        std::lock_guard<std::mutex> lock(fileMutex_);
+        return load();
+    }
+
+    std::optional<double> EvaluationCache::lookup(Key key, double pruningBound)
+    {
+        Shard &shard = shardOf(key);
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.entries.find(key);
+            if (it != shard.entries.end() && it->second.bounds.contains(pruningBound))
+            {
+                hits_.fetch_add(1, std::memory_order_relaxed);
+                return it->second.score;
+            }
+        }
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+
+    void EvaluationCache::store(Key key, double score, const BoundRange &bounds)
+    {
+        if (!insert(key, {score, bounds}) || !file_)
+        {
+            return;
+        }
+
+        Record record{key, score, bounds.low, bounds.high, 0};
+        record.checksum = checksum(record);
+
+        // One fwrite of a whole record, flushed at once, becomes one append
+        std::lock_guard<std::mutex> lock(fileMutex_);
+        std::fwrite(&record, sizeof(record), 1, file_);
+        std::fflush(file_);
+    }
+
+    std::uint64_t EvaluationCache::hits() const
+    {
+        return hits_.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t EvaluationCache::misses() const
+    {
+        return misses_.load(std::memory_order_relaxed);
+    }
+
+    std::size_t EvaluationCache::size() const
+    {
+        std::size_t total = 0;
+        for (const Shard &shard : shards_)
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.entries.size();
+        }
+        return total;
+    }
+
+    const std::string &EvaluationCache::path() const
+    {
+        return path_;
+    }
+
+} // namespace sim::core
@@ -0,0 +1,129 @@
+#include "../../include/core/metrics.hpp"
+#include "../../include/core/simulator.hpp"
+#include <algorithm>
+#include <sstream>
+
+namespace sim::core
+{
+
+    namespace
+    {
+        static_assert(static_cast<std::size_t>(Simulator::TerminationReason::ClosestApproach) + 1 ==
+                          OptimizerMetrics::TERMINATION_REASONS,
+                      "OptimizerMetrics needs a slot for every termination reason");
+
+        const char *const TERMINATION_NAMES[OptimizerMetrics::TERMINATION_REASONS] = {
+            "none", "outOfFuel", "arrived", "timeLimit", "pruned", "groundContact", "closestApproach"};
+
+        template <typename T, std::size_t N>
+        void writeArray(std::ostringstream &out, const std::array<T, N> &values)
+        {
+            out << '[';
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                out << (i ? "," : "") << values[i];
+            }
+            out << ']';
+        }
+    }
+
+    const char *terminationReasonName(std::size_t terminationReason)
+    {
+        return terminationReason < OptimizerMetrics::TERMINATION_REASONS ? TERMINATION_NAMES[terminationReason]
+                                                                          : "unknown";
+    }
+
+    void SimulationMetrics::merge(const SimulationMetrics &other)
+    {
+        steps += other.steps;
+        forceNanoseconds += other.forceNanoseconds;
+        autopilotNanoseconds += other.autopilotNanoseconds;
+        integrationNanoseconds += other.integrationNanoseconds;
+        for (std::size_t i = 0; i < MAX_PHASES; ++i)
+        {
+            phases[i].steps += other.phases[i].steps;
+            phases[i].nanoseconds += other.phases[i].nanoseconds;
+            phases[i].simulatedSeconds += other.phases[i].simulatedSeconds;
+        }
+    }
+
+    std::string SimulationMetrics::toJson() const
+    {
+        std::ostringstream out;
+        out << "{\"steps\":" << steps
+            << ",\"forceNanoseconds\":" << forceNanoseconds
+            << ",\"autopilotNanoseconds\":" << autopilotNanoseconds
+            << ",\"integrationNanoseconds\":" << integrationNanoseconds
+            << ",\"phases\":[";
+
+        // Trailing phases no autopilot reached are left out
+        std::size_t used = MAX_PHASES;
+        while (used > 0 && phases[used - 1].steps == 0)
+        {
+            --used;
+        }
+        for (std::size_t i = 0; i < used; ++i)
+        {
+            out << (i ? "," : "") << "{\"steps\":" << phases[i].steps
+                << ",\"nanoseconds\":" << phases[i].nanoseconds
+                << ",\"simulatedSeconds\":" << phases[i].simulatedSeconds << '}';
+        }
+        out << "]}";
+        return out.str();
+    }
+
+    double OptimizerMetrics::evaluationsPerSecond() const
+    {
+        return wallSeconds > 0.0 ? static_cast<double>(evaluations) / wallSeconds : 0.0;
+    }
+
+    void OptimizerMetrics::addRun(std::size_t terminationReason, std::uint64_t steps)
+    {
+        ++evaluations;
+        std::size_t reason = std::min(terminationReason, TERMINATION_REASONS - 1);
+        ++terminations[reason];
+        terminationSteps[reason] += steps;
+
+        std::size_t bucket = 0;
+        while (bucket + 1 < RUN_LENGTH_BUCKETS && (steps >> (bucket + 1)) != 0)
+        {
+            ++bucket;
+        }
+        ++runLengths[bucket];
+    }
+
+    void OptimizerMetrics::merge(const OptimizerMetrics &other)
+    {
+        evaluations += other.evaluations;
+        wallSeconds += other.wallSeconds;
+        for (std::size_t i = 0; i < TERMINATION_REASONS; ++i)
+        {
+            terminations[i] += other.terminations[i];
+            terminationSteps[i] += other.terminationSteps[i];
+        }
+        for (std::size_t i = 0; i < RUN_LENGTH_BUCKETS; ++i)
+        {
+            runLengths[i] += other.runLengths[i];
+        }
+        simulation.merge(other.simulation);
+    }
+
+    std::string OptimizerMetrics::toJson() const
+    {
+        std::ostringstream out;
+        out << "{\"evaluations\":" << evaluations
+            << ",\"wallSeconds\":" << wallSeconds
+            << ",\"evaluationsPerSecond\":" << evaluationsPerSecond()
+            << ",\"terminations\":{";
+        for (std::size_t i = 0; i < TERMINATION_REASONS; ++i)
+        {
+            out << (i ? "," : "") << '"' << TERMINATION_NAMES[i] << "\":{\"runs\":" << terminations[i]
+                << ",\"steps\":" << terminationSteps[i] << '}';
+        }
+        out << "},\"runLengthLog2Histogram\":";
+        writeArray(out, runLengths);
+        out << ",\"simulation\":" << simulation.toJson() << '}';
+        return out.str();
+    }
+
+} // namespace sim::core
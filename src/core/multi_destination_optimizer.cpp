@@ -0,0 +1,124 @@
+#include "../../include/core/multi_destination_optimizer.hpp"
+#include "../../include/utils/logger.hpp"
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+
+using sim::utils::Logger;
+using sim::utils::ThreadPool;
+
+namespace sim::core
+{
+
+    MultiDestinationOptimizer::MultiDestinationOptimizer(std::shared_ptr<Environment> env, std::uint64_t seed)
+        : env_(std::move(env)), seed_(seed)
+    {
+        if (!env_)
+        {
+            throw std::invalid_argument("MultiDestinationOptimizer needs an environment");
+        }
+    }
+
+    void MultiDestinationOptimizer::setThreadCount(unsigned threads)
+    {
+        if (threads != threadCount_)
+        {
+            threadCount_ = threads;
+            pool_.reset();
+        }
+    }
+
+    unsigned MultiDestinationOptimizer::threadCount() const
+    {
+        return threadCount_ == 0 ? static_cast<unsigned>(ThreadPool::defaultThreadCount()) : threadCount_;
+    }
+
+    void MultiDestinationOptimizer::setConfigure(Configure configure)
+    {
+        configure_ = std::move(configure);
+    }
+
+    void MultiDestinationOptimizer::run(const std::vector<Vector3> &destinations, int iterations,
+                                        const ResultCallback &onResult)
+    {
+        if (!pool_)
+        {
+            pool_ = std::make_shared<ThreadPool>(threadCount_);
+        }
+
+        std::mutex resultMutex;
+        std::atomic<std::uint64_t> evaluations{0};
+
+        auto optimizeOne = [&](std::size_t index)
+        {
+            Optimizer optimizer(env_, destinations[index], seed_);
+            optimizer.setThreadPool(pool_);
+            // Thousands of per-destination summaries would drown everything else
+            optimizer.setSummaryLogging(false);
+            if (configure_)
+            {
+                configure_(optimizer);
+            }
+            optimizer.optimize(iterations);
+            evaluations.fetch_add(optimizer.evaluationCount(), std::memory_order_relaxed);
+
+            Result result;
+            result.destination = destinations[index];
+            result.score = optimizer.getBestScore();
+            if (auto params = optimizer.bestParameters())
+            {
+                result.parameters = *params;
+                result.json = optimizer.toJson();
+            }
+
+            std::lock_guard<std::mutex> lock(resultMutex);
+            onResult(index, result);
+        };
+
+        // Destinations are claimed one at a time, so a thread that finishes early
+        // takes the next one, and once none are left it picks up batch tasks the
+        // running Optimizers queued on the same pool
+        pool_->parallelFor(destinations.size(), optimizeOne);
+
+        Logger::info("MultiDestinationOptimizer: ", destinations.size(), " destinations, ",
+                     evaluations.load(), " evaluations on ", pool_->size(), " threads");
+    }
+
+    std::vector<MultiDestinationOptimizer::Result> MultiDestinationOptimizer::optimize(
+        const std::vector<Vector3> &destinations, int iterations, const ResultCallback &onResult)
+    {
+        std::vector<Result> results(destinations.size());
+        auto store = [&](std::size_t index, const Result &result)
+        {
+            results[index] = result;
+            if (onResult)
+            {
+                onResult(index, result);
+            }
+        };
+        run(destinations, iterations, store);
+        return results;
+    }
+
+    void MultiDestinationOptimizer::optimize(const std::vector<Vector3> &destinations, int iterations,
+                                             std::ostream &out)
+    {
+        // Records that finished ahead of an earlier destination wait here
+        std::map<std::size_t, std::string> pending;
+        std::size_t next = 0;
+
+        auto write = [&](std::size_t index, const Result &result)
+        {
+            pending.emplace(index, result.json.empty() ? "null" : result.json);
+            for (auto it = pending.begin(); it != pending.end() && it->first == next; it = pending.erase(it))
+            {
+                out << it->second << '\n';
+                ++next;
+            }
+            out.flush();
+        };
+        run(destinations, iterations, write);
+    }
+
+} // namespace sim::core
@@ -1,146 +1,1075 @@
 #include "../../include/core/optimizer.hpp"
 #include "../../include/utils/logger.hpp"
 #include "../../include/utils/config.hpp"
+#include "../../include/utils/random.hpp"
 #include <algorithm>
+#include <chrono>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
 #include <cmath>
 
+using sim::utils::Logger;
+using sim::utils::ThreadPool;
+
 namespace sim::core
 {
 
-    Optimizer::Optimizer(std::shared_ptr<Environment> env, const Vector3 &destination)
-        : env_(env), destination_(destination), bestScore_(std::numeric_limits<double>::max()) {}
+    namespace
+    {
+        // Candidates are generated and evaluated in batches so that memory stays
+        // bounded for very large iteration counts,
+        // and so that the pruning bound tightens regularly
+        constexpr int BATCH_SIZE = 256;
+
+        // A shared_ptr to `object` that owns nothing: it allocates no control block
+        // and its copies touch no reference count. `object` must outlive them all.
+        template <typename T>
+        std::shared_ptr<T> borrow(T &object)
+        {
+            return std::shared_ptr<T>(std::shared_ptr<T>(), &object);
+        }
+    }
+
+    Optimizer::Optimizer(std::shared_ptr<Environment> env, const Vector3 &destination, std::uint64_t seed)
+        : env_(env), destination_(destination), bestScore_(std::numeric_limits<double>::max()),
+          bounds_(defaultBounds()), seed_(seed), sampler_(makeSampler(SamplerType::Random, seed, 0)) {}
+
+    Optimizer::~Optimizer() = default;
 
     void Optimizer::optimize(int iterations)
     {
-        for (int i = 0; i < iterations; ++i)
+        optimize(iterations, nullptr);
+    }
+
+    void Optimizer::optimize(int iterations, const ProgressCallback &progress,
+                             const sim::utils::CancellationToken *cancel)
+    {
+        if (iterations <= 0)
+        {
+            return;
+        }
+        cancel_ = cancel;
+        deadline_ = std::chrono::steady_clock::time_point::max();
+        search(iterations, BATCH_SIZE, progress);
+    }
+
+    void Optimizer::optimizeFor(std::chrono::steady_clock::duration budget,
+                                const ProgressCallback &progress,
+                                const sim::utils::CancellationToken *cancel)
+    {
+        cancel_ = cancel;
+        deadline_ = std::chrono::steady_clock::now() + budget;
+        search(std::numeric_limits<int>::max(), static_cast<int>(threadCount_), progress);
+    }
+
+    bool Optimizer::stopRequested() const
+    {
+        if (cancel_ && cancel_->isCancelled())
+        {
+            return true;
+        }
+        // bestScore_ only changes between batches, so workers may read it here
+        return bestScore_ < std::numeric_limits<double>::max() &&
+               std::chrono::steady_clock::now() >= deadline_;
+    }
+
+    void Optimizer::search(int iterations, int firstBatch, const ProgressCallback &progress)
+    {
+        if (running_.exchange(true))
+        {
+            throw std::logic_error("Optimizer::optimize is already running");
+        }
+        struct Finish
+        {
+            Optimizer &optimizer;
+            ~Finish()
+            {
+                optimizer.cancel_ = nullptr;
+                optimizer.running_ = false;
+            }
+        } finish{*this};
+
+        std::uint64_t evaluations = evaluationCount_.load();
+        std::uint64_t pruned = prunedCount_.load();
+        std::uint64_t hits = cacheHits_.load(), misses = cacheMisses_.load();
+        auto start = std::chrono::steady_clock::now();
+
+        auto afterBatch = [&]
+        {
+            if (progress)
+            {
+                progress({evaluationCount_.load() - evaluations,
+                          std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(),
+                          bestScore_, bestParameters_});
+            }
+        };
+
+        if (searchMethod_ == SearchMethod::RandomSampling)
+        {
+            optimizeBySampling(iterations, firstBatch, afterBatch);
+        }
+        else
+        {
+            optimizeByPopulation(iterations, afterBatch);
+        }
+
+        if (metricsEnabled_)
+        {
+            std::lock_guard<std::mutex> lock(metricsMutex_);
+            metrics_.wallSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        if (!summaryLogging_)
+        {
+            return;
+        }
+        Logger::info("Optimizer: ", evaluationCount_.load() - evaluations,
+                     " evaluations, ", prunedCount_.load() - pruned,
+                     " pruned early, best score: ", bestScore_);
+        if (cache_)
+        {
+            Logger::info("Evaluation cache: ", cacheHits_.load() - hits, " hits, ", cacheMisses_.load() - misses,
+                         " misses, ", cache_->size(), " entries");
+        }
+    }
+
+    void Optimizer::optimizeBySampling(int iterations, int firstBatch, const std::function<void()> &afterBatch)
+    {
+        // A Latin hypercube is only balanced over the run it was laid out for; an
+        // open-ended run is laid out in blocks of a full batch
+        if (samplerType_ == SamplerType::LatinHypercube && !customSampler_)
         {
-            double dryMass, initialFuel, burnRate,
-                specificImpulse, turnStartAltitude, turnRate;
-            generateRandomParameters(dryMass, initialFuel, burnRate,
-                                     specificImpulse, turnStartAltitude, turnRate);
+            sampler_ = makeSampler(SamplerType::LatinHypercube,
+                                   sim::utils::hashCombine(seed_, layoutCount_++),
+                                   static_cast<std::uint32_t>(
+                                       iterations == std::numeric_limits<int>::max() ? BATCH_SIZE : iterations));
+            nextIndex_ = 0;
+        }
+
+        std::vector<OptimizedParameters> candidates;
+        std::vector<double> bounds;
+        std::vector<double> scores;
 
-            double score = evaluateParameters(dryMass, initialFuel, burnRate,
-                                              specificImpulse, turnStartAltitude, turnRate);
+        int limit = std::clamp(firstBatch, 1, BATCH_SIZE);
+        double secondsPerCandidate = 0.0;
+        for (int done = 0; done < iterations && !stopRequested();)
+        {
+            int batch = std::min(limit, iterations - done);
+            limit = std::min(limit * 2, BATCH_SIZE);
 
-            if (score < bestScore_)
+            // Near a deadline, only start what the last batch suggests will fit
+            auto batchStart = std::chrono::steady_clock::now();
+            if (deadline_ != std::chrono::steady_clock::time_point::max() && secondsPerCandidate > 0.0)
             {
-                bestScore_ = score;
-                bestRocket_ = std::make_shared<Rocket>(dryMass,
-                                                       initialFuel,
-                                                       burnRate,
-                                                       specificImpulse,
-                                                       10.0,
-                                                       0.2);
+                double remaining = std::chrono::duration<double>(deadline_ - batchStart).count();
+                int fits = static_cast<int>(std::min(remaining / secondsPerCandidate, static_cast<double>(BATCH_SIZE)));
+                batch = std::min(batch, std::max(fits, static_cast<int>(threadCount_)));
+            }
 
-                bestAutopilot_ = std::make_shared<GravityTurnAutopilot>(
-                    (destination_.y() - sim::utils::config::EARTH_RADIUS) * .6,
-                    destination_,
-                    env_,
-                    turnStartAltitude,
-                    turnRate, 8);
+            // Each candidate depends only on its index, so the batch contents do not
+            // depend on how it is later split across threads. Candidates a stop
+            // request skips are not revisited.
+            candidates.resize(batch);
+            for (int i = 0; i < batch; ++i)
+            {
+                candidates[i] = generateRandomParameters(nextIndex_ + i);
             }
+            nextIndex_ += batch;
+
+            // A candidate that cannot beat the incumbent cannot change the result
+            bounds.assign(candidates.size(), pruningBound());
+            evaluateBatch(candidates, bounds, scores);
+            mergeBatch(candidates, scores);
+            afterBatch();
+
+            auto batchTime = std::chrono::steady_clock::now() - batchStart;
+            secondsPerCandidate = std::chrono::duration<double>(batchTime).count() / batch;
+            done += batch;
         }
     }
 
-    void Optimizer::generateRandomParameters(
-        double &dryMass, double &initialFuel, double &burnRate,
-        double &specificImpulse, double &turnStartAltitude, double &turnRate)
+    void Optimizer::optimizeByPopulation(int iterations, const std::function<void()> &afterBatch)
     {
+        if (!strategy_)
+        {
+            if (searchMethod_ == SearchMethod::CmaEs)
+            {
+                strategy_ = std::make_unique<CmaEs>(seed_);
+            }
+            else
+            {
+                strategy_ = std::make_unique<DifferentialEvolution>(seed_);
+            }
+        }
+
+        std::vector<SearchStrategy::Point> population;
+        std::vector<OptimizedParameters> candidates;
+        std::vector<double> bounds;
+        std::vector<double> scores;
+
+        for (int done = 0; done < iterations && !stopRequested();)
+        {
+            strategy_->ask(population);
+
+            // A generation cut short by the budget or a stop request is not told, so
+            // the next optimize() call proposes it again in full
+            std::size_t count = std::min<std::size_t>(population.size(), iterations - done);
+            candidates.resize(count);
+            bounds.resize(count);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                candidates[i] = toParameters(population[i]);
+                // Not the incumbent: a run worse than the best can still be selected
+                bounds[i] = pruning_ != PruningMode::Off ? strategy_->pruningBound(i)
+                                                         : std::numeric_limits<double>::infinity();
+            }
 
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_real_distribution<> dis(0.8, 1.2);
+            bool complete = evaluateBatch(candidates, bounds, scores);
+            mergeBatch(candidates, scores);
+            afterBatch();
+
+            if (complete && count == population.size())
+            {
+                strategy_->tell(population, scores);
+            }
+
+            done += static_cast<int>(count);
+        }
+    }
+
+    double Optimizer::pruningBound() const
+    {
+        // The incumbent is fixed for the whole batch, so which candidates get pruned
+        // does not depend on the order in which threads finish. Population methods
+        // take their bounds from the strategy instead.
+        return pruning_ != PruningMode::Off ? bestScore_ : std::numeric_limits<double>::infinity();
+    }
 
-        dryMass = 20000.0 * dis(gen);
-        initialFuel = 200000.0 * dis(gen);
-        burnRate = 500.0 * dis(gen);
-        specificImpulse = 600.0 * dis(gen);
-        turnStartAltitude = 10000 + 5000 * dis(gen);
-        turnRate = 0.15 + 0.5 * dis(gen);
+    EvaluationCache::KeyBuilder Optimizer::cacheKeyBase() const
+    {
+        EvaluationCache::KeyBuilder key;
+        key.add(destination_.x()).add(destination_.y()).add(destination_.z());
+        key.add(static_cast<std::uint64_t>(env_->model())).add(env_->densityScale());
+        key.add(timeStep_);
+        key.add(static_cast<std::uint64_t>(integrator_));
+        // Receding pruning stops runs the delta-v bound alone lets through
+        key.add(static_cast<std::uint64_t>(pruning_ == PruningMode::Aggressive));
+        return key;
     }
 
-    double Optimizer::evaluateParameters(
-        double dryMass, double initialFuel, double burnRate,
-        double specificImpulse, double turnStartAltitude, double turnRate)
+    bool Optimizer::evaluateBatch(const std::vector<OptimizedParameters> &candidates,
+                                  const std::vector<double> &pruningBounds, std::vector<double> &scores)
     {
+        if (!cache_)
+        {
+            return simulateBatch(candidates, pruningBounds, scores, nullptr);
+        }
+
+        EvaluationCache::KeyBuilder base = cacheKeyBase();
+
+        scores.assign(candidates.size(), std::numeric_limits<double>::max());
+        std::vector<EvaluationCache::Key> keys(candidates.size());
+        std::vector<std::size_t> misses;
+        std::vector<OptimizedParameters> missing;
+        std::vector<double> missingBounds;
+        for (std::size_t i = 0; i < candidates.size(); ++i)
+        {
+            EvaluationCache::KeyBuilder key = base;
+            for (auto field : PARAMETER_FIELDS)
+            {
+                key.addQuantized(candidates[i].*field);
+            }
+            keys[i] = key.key();
+
+            if (auto cached = cache_->lookup(keys[i], pruningBounds[i]))
+            {
+                scores[i] = *cached;
+            }
+            else
+            {
+                misses.push_back(i);
+                missing.push_back(candidates[i]);
+                missingBounds.push_back(pruningBounds[i]);
+            }
+        }
+        cacheHits_.fetch_add(candidates.size() - misses.size(), std::memory_order_relaxed);
+        cacheMisses_.fetch_add(misses.size(), std::memory_order_relaxed);
+        if (missing.empty())
+        {
+            return true;
+        }
 
-        auto rocket = std::make_shared<Rocket>(dryMass,
-                                               initialFuel,
-                                               burnRate,
-                                               specificImpulse,
-                                               10.0,
-                                               0.2);
+        std::vector<double> missScores;
+        std::vector<EvaluationCache::BoundRange> ranges;
+        bool complete = simulateBatch(missing, missingBounds, missScores, &ranges);
+        for (std::size_t k = 0; k < misses.size(); ++k)
+        {
+            scores[misses[k]] = missScores[k];
+            if (!std::isnan(ranges[k].low))
+            {
+                cache_->store(keys[misses[k]], missScores[k], ranges[k]);
+            }
+        }
+        return complete;
+    }
 
-        auto autopilot = std::make_shared<GravityTurnAutopilot>((destination_.y() - sim::utils::config::EARTH_RADIUS) * .6,
-                                                                destination_,
-                                                                env_,
-                                                                turnStartAltitude,
-                                                                turnRate,
-                                                                8);
+    bool Optimizer::simulateBatch(const std::vector<OptimizedParameters> &candidates,
+                                  const std::vector<double> &pruningBounds,
+                                  std::vector<double> &scores,
+                                  std::vector<EvaluationCache::BoundRange> *ranges)
+    {
+        scores.assign(candidates.size(), std::numeric_limits<double>::max());
+        if (ranges)
+        {
+            constexpr double unknown = std::numeric_limits<double>::quiet_NaN();
+            ranges->assign(candidates.size(), {unknown, unknown});
+        }
 
-        Simulator sim(rocket, env_, destination_, autopilot);
-        sim.run(sim::utils::config::TIME_STEP);
+        // Batch simulation flies groups of candidates in lockstep; the groups are kept
+        // small enough that every thread still gets one. It only integrates with
+        // semi-implicit Euler.
+        bool lockstep = batchSimulation_ && integrator_ == Simulator::Integrator::SemiImplicitEuler;
+        std::size_t group = 1;
+        if (lockstep)
+        {
+            std::size_t perThread = (candidates.size() + threadCount_ - 1) / threadCount_;
+            group = std::clamp<std::size_t>(perThread, 1, LANES_PER_GROUP);
+        }
 
-        Vector3 finalPos = rocket->position();
-        double distanceToTarget = (finalPos - destination_).length();
+        std::vector<std::size_t> order;
+        std::vector<SharedAscent> ascents;
+        std::size_t singles = groupByRocket(candidates, order, ascents);
 
-        double fuelLeft = rocket->totalMass() - rocket->dryMass();
+        // Set once a task sees a stop request; later tasks are skipped
+        std::atomic<bool> stopped{false};
+        auto skip = [&]
+        {
+            if (!stopped.load(std::memory_order_relaxed) && stopRequested())
+            {
+                stopped.store(true, std::memory_order_relaxed);
+            }
+            return stopped.load(std::memory_order_relaxed);
+        };
+
+        auto ascend = [&](std::size_t index)
+        {
+            if (skip())
+            {
+                return;
+            }
+            Logger::ScopedMute mute;
+            OptimizerMetrics local;
+            OptimizerMetrics *metrics = metricsEnabled_ ? &local : nullptr;
+            flyAscent(candidates, order, ascents[index], pruningBounds, scores, metrics, ranges);
+            if (metrics)
+            {
+                std::lock_guard<std::mutex> lock(metricsMutex_);
+                metrics_.merge(local);
+            }
+        };
+        forEachTask(ascents.size(), ascend);
+
+        // Candidates are evaluated in slices of the order, each slice either flown
+        // from the launch pad or from the end of one shared ascent
+        struct Slice
+        {
+            std::size_t first, last;
+            const SharedAscent *ascent;
+        };
+        std::vector<Slice> slices;
+        auto split = [&](std::size_t first, std::size_t last, const SharedAscent *ascent)
+        {
+            for (; first < last; first += group)
+            {
+                slices.push_back({first, std::min(first + group, last), ascent});
+            }
+        };
+        split(0, singles, nullptr);
+        for (const SharedAscent &ascent : ascents)
+        {
+            if (ascent.snapshot)
+            {
+                split(ascent.first, ascent.last, &ascent);
+            }
+        }
+
+        auto evaluate = [&](std::size_t index)
+        {
+            if (skip())
+            {
+                return;
+            }
+            // Candidates run out of fuel and hit the ground by the thousand; their
+            // warnings say nothing about the search
+            Logger::ScopedMute mute;
+            const Slice &slice = slices[index];
+
+            // Collected per task and merged once, so threads do not contend per run
+            OptimizerMetrics local;
+            OptimizerMetrics *metrics = metricsEnabled_ ? &local : nullptr;
+            if (lockstep)
+            {
+                evaluateGroup(candidates, &order[slice.first], slice.last - slice.first,
+                              pruningBounds, scores, metrics, slice.ascent, ranges);
+            }
+            else
+            {
+                for (std::size_t k = slice.first; k < slice.last; ++k)
+                {
+                    scores[order[k]] = evaluateParameters(candidates[order[k]], pruningBounds[order[k]], metrics, slice.ascent,
+                                                          ranges ? &(*ranges)[order[k]] : nullptr);
+                }
+            }
+
+            if (metrics)
+            {
+                std::lock_guard<std::mutex> lock(metricsMutex_);
+                metrics_.merge(local);
+            }
+        };
+        forEachTask(slices.size(), evaluate);
+        return !stopped.load();
+    }
+
+    void Optimizer::forEachTask(std::size_t count, const std::function<void(std::size_t)> &task)
+    {
+        if (threadCount_ == 1 || count < 2)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                task(i);
+            }
+            return;
+        }
+
+        if (!pool_)
+        {
+            pool_ = std::make_shared<ThreadPool>(threadCount_);
+        }
+
+        pool_->parallelFor(count, task);
+    }
+
+    std::size_t Optimizer::groupByRocket(const std::vector<OptimizedParameters> &candidates,
+                                         std::vector<std::size_t> &order,
+                                         std::vector<SharedAscent> &ascents) const
+    {
+        order.resize(candidates.size());
+        std::iota(order.begin(), order.end(), std::size_t{0});
+        if (!prefixSharing_)
+        {
+            return order.size();
+        }
+
+        auto rocketOf = [&candidates](std::size_t i)
+        {
+            const OptimizedParameters &p = candidates[i];
+            return std::make_tuple(p.dryMass, p.initialFuel, p.burnRate, p.specificImpulse);
+        };
+
+        std::vector<std::size_t> byRocket = order;
+        std::stable_sort(byRocket.begin(), byRocket.end(), [&](std::size_t a, std::size_t b)
+                         { return rocketOf(a) < rocketOf(b); });
+
+        // Candidates of a rocket nobody else flies keep their place at the front;
+        // the members of each shared ascent follow, next to each other
+        std::vector<char> shared(candidates.size(), 0);
+        std::vector<std::pair<std::size_t, std::size_t>> runs;
+        for (std::size_t first = 0, last; first < byRocket.size(); first = last)
+        {
+            for (last = first + 1; last < byRocket.size() && rocketOf(byRocket[last]) == rocketOf(byRocket[first]); ++last)
+            {
+            }
+            if (last - first >= 2)
+            {
+                runs.emplace_back(first, last);
+                for (std::size_t k = first; k < last; ++k)
+                {
+                    shared[byRocket[k]] = 1;
+                }
+            }
+        }
+
+        order.clear();
+        for (std::size_t i = 0; i < candidates.size(); ++i)
+        {
+            if (!shared[i])
+            {
+                order.push_back(i);
+            }
+        }
+        std::size_t singles = order.size();
+
+        for (const auto &[first, last] : runs)
+        {
+            SharedAscent ascent;
+            ascent.first = order.size();
+            order.insert(order.end(), byRocket.begin() + first, byRocket.begin() + last);
+            ascent.last = order.size();
+            ascents.push_back(std::move(ascent));
+        }
+        return singles;
+    }
+
+    void Optimizer::flyAscent(const std::vector<OptimizedParameters> &candidates,
+                              const std::vector<std::size_t> &order, SharedAscent &ascent,
+                              const std::vector<double> &pruningBounds, std::vector<double> &scores,
+                              OptimizerMetrics *metrics, std::vector<EvaluationCache::BoundRange> *ranges)
+    {
+        // Any member will do: until the turn, guidance only depends on the rocket
+        const OptimizedParameters &params = candidates[order[ascent.first]];
+        // Pruned on the way up, the ascent is worse than what every member must beat
+        double pruningBound = -std::numeric_limits<double>::infinity();
+        for (std::size_t k = ascent.first; k < ascent.last; ++k)
+        {
+            pruningBound = std::max(pruningBound, pruningBounds[order[k]]);
+        }
+        auto autopilot = std::make_shared<GravityTurnAutopilot>(buildAutopilot(params, borrow(*env_)));
+        ascent.simulator = makeSimulator(params, autopilot, pruningBound, metrics != nullptr);
+
+        bool ended = ascent.simulator->runUntil(timeStep_, [&autopilot](const Simulator &sim)
+                                                { return autopilot->isVerticalAscentOver(sim.rocket()); });
+        if (metrics)
+        {
+            metrics->simulation.merge(ascent.simulator->metrics());
+        }
+
+        if (!ended)
+        {
+            ascent.snapshot = ascent.simulator->snapshot();
+            return;
+        }
+
+        // Out of fuel or pruned on the way up, the same way for every member
+        for (std::size_t k = ascent.first; k < ascent.last; ++k)
+        {
+            scores[order[k]] = finishRun(*ascent.simulator, ascent.simulator->rocket(), metrics,
+                                         ranges ? &(*ranges)[order[k]] : nullptr);
+        }
+    }
+
+    GravityTurnAutopilot Optimizer::SharedAscent::autopilotFor(const OptimizedParameters &params) const
+    {
+        const auto &ascending = static_cast<const GravityTurnAutopilot &>(*snapshot->autopilot);
+        return ascending.withTurn(params.turnStartAltitude, params.turnRate);
+    }
+
+    void Optimizer::evaluateGroup(const std::vector<OptimizedParameters> &candidates,
+                                  const std::size_t *indices, std::size_t count,
+                                  const std::vector<double> &pruningBounds, std::vector<double> &scores,
+                                  OptimizerMetrics *metrics, const SharedAscent *ascent,
+                                  std::vector<EvaluationCache::BoundRange> *ranges)
+    {
+        BatchSimulator batch(env_, destination_);
+        for (std::size_t k = 0; k < count; ++k)
+        {
+            const OptimizedParameters &params = candidates[indices[k]];
+            if (ascent)
+            {
+                batch.add(*ascent->snapshot, ascent->autopilotFor(params));
+            }
+            else
+            {
+                batch.add(buildRocket(params), buildAutopilot(params, borrow(*env_)));
+            }
+        }
+
+        for (std::size_t k = 0; k < count; ++k)
+        {
+            batch.setPruningBound(k, pruningBounds[indices[k]]);
+        }
+        batch.setRecedingPruning(pruning_ == PruningMode::Aggressive);
+        batch.run(timeStep_);
+
+        evaluationCount_.fetch_add(count, std::memory_order_relaxed);
+
+        for (std::size_t k = 0; k < count; ++k)
+        {
+            const BatchResult &result = batch.result(k);
+            double &score = scores[indices[k]];
+            if (metrics)
+            {
+                metrics->addRun(static_cast<std::size_t>(result.reason), result.steps);
+            }
+            // Pruned runs score infinity, as in finishRun
+            bool pruned = result.reason == Simulator::TerminationReason::Pruned;
+            if (pruned)
+            {
+                prunedCount_.fetch_add(1, std::memory_order_relaxed);
+                score = std::numeric_limits<double>::infinity();
+            }
+            else
+            {
+                score = this->score(result.state.position, result.state.fuelMass);
+            }
+            if (ranges)
+            {
+                double high = pruned ? result.prunedDistance : std::numeric_limits<double>::infinity();
+                (*ranges)[indices[k]] = {result.pruningPeak, high};
+            }
+        }
+    }
+
+    double Optimizer::score(const Vector3 &finalPosition, double fuelLeft) const
+    {
+        double distanceToTarget = (finalPosition - destination_).length();
         double fuelPenalty = fuelLeft * 0.01;
 
         return distanceToTarget + fuelPenalty;
     }
 
+    Rocket Optimizer::buildRocket(const OptimizedParameters &params) const
+    {
+        return Rocket(params.dryMass,
+                      params.initialFuel,
+                      params.burnRate,
+                      params.specificImpulse,
+                      10.0,
+                      0.2);
+    }
+
+    GravityTurnAutopilot Optimizer::buildAutopilot(const OptimizedParameters &params,
+                                                   const std::shared_ptr<Environment> &env) const
+    {
+        return GravityTurnAutopilot((destination_.y() - sim::utils::config::EARTH_RADIUS) * .6,
+                                    destination_,
+                                    env,
+                                    params.turnStartAltitude,
+                                    params.turnRate,
+                                    8);
+    }
+
+    void Optimizer::mergeBatch(const std::vector<OptimizedParameters> &candidates,
+                               const std::vector<double> &scores)
+    {
+        // Merging in candidate order with a strict comparison keeps the earliest of
+        // equally good candidates, exactly as a sequential loop does
+        for (std::size_t i = 0; i < candidates.size(); ++i)
+        {
+            if (scores[i] < bestScore_)
+            {
+                acceptBest(candidates[i], scores[i]);
+            }
+        }
+    }
+
+    void Optimizer::acceptBest(const OptimizedParameters &params, double score)
+    {
+        std::lock_guard<std::mutex> lock(bestMutex_);
+        bestScore_ = score;
+        bestParameters_ = params;
+        hasBest_ = true;
+    }
+
+    void Optimizer::setThreadCount(unsigned threads)
+    {
+        if (threads == 0)
+        {
+            threads = static_cast<unsigned>(ThreadPool::defaultThreadCount());
+        }
+
+        if (threads != threadCount_)
+        {
+            threadCount_ = threads;
+            pool_.reset();
+        }
+    }
+
+    unsigned Optimizer::threadCount() const
+    {
+        return threadCount_;
+    }
+
+    void Optimizer::setThreadPool(std::shared_ptr<ThreadPool> pool)
+    {
+        if (!pool)
+        {
+            throw std::invalid_argument("Optimizer::setThreadPool: null pool");
+        }
+        threadCount_ = static_cast<unsigned>(pool->size());
+        pool_ = std::move(pool);
+    }
+
+    void Optimizer::setSeed(std::uint64_t seed)
+    {
+        seed_ = seed;
+        nextIndex_ = 0;
+        layoutCount_ = 0;
+        strategy_.reset();
+        if (!customSampler_)
+        {
+            sampler_ = makeSampler(samplerType_, seed_, 0);
+        }
+    }
+
+    std::uint64_t Optimizer::seed() const
+    {
+        return seed_;
+    }
+
+    void Optimizer::setSampler(SamplerType type)
+    {
+        samplerType_ = type;
+        customSampler_ = false;
+        nextIndex_ = 0;
+        sampler_ = makeSampler(type, seed_, 0);
+    }
+
+    void Optimizer::setSampler(std::shared_ptr<const ParameterSampler> sampler)
+    {
+        if (!sampler)
+        {
+            throw std::invalid_argument("Optimizer sampler must not be null");
+        }
+        sampler_ = std::move(sampler);
+        customSampler_ = true;
+        nextIndex_ = 0;
+    }
+
+    SamplerType Optimizer::samplerType() const
+    {
+        return samplerType_;
+    }
+
+    void Optimizer::setPruning(PruningMode mode)
+    {
+        pruning_ = mode;
+    }
+
+    PruningMode Optimizer::pruning() const
+    {
+        return pruning_;
+    }
+
+    std::uint64_t Optimizer::evaluationCount() const
+    {
+        return evaluationCount_.load();
+    }
+
+    std::uint64_t Optimizer::prunedCount() const
+    {
+        return prunedCount_.load();
+    }
+
+    void Optimizer::setBatchSimulation(bool enabled)
+    {
+        batchSimulation_ = enabled;
+    }
+
+    bool Optimizer::batchSimulation() const
+    {
+        return batchSimulation_;
+    }
+
+    void Optimizer::setIntegrator(Simulator::Integrator integrator)
+    {
+        integrator_ = integrator;
+    }
+
+    Simulator::Integrator Optimizer::integrator() const
+    {
+        return integrator_;
+    }
+
+    void Optimizer::setTimeStep(double dt)
+    {
+        if (!(dt > 0.0))
+        {
+            throw std::invalid_argument("Optimizer time step must be positive");
+        }
+        timeStep_ = dt;
+    }
+
+    double Optimizer::timeStep() const
+    {
+        return timeStep_;
+    }
+
+    void Optimizer::setPrefixSharing(bool enabled)
+    {
+        prefixSharing_ = enabled;
+    }
+
+    bool Optimizer::prefixSharing() const
+    {
+        return prefixSharing_;
+    }
+
+    void Optimizer::setSummaryLogging(bool enabled)
+    {
+        summaryLogging_ = enabled;
+    }
+
+    bool Optimizer::summaryLogging() const
+    {
+        return summaryLogging_;
+    }
+
+    void Optimizer::setEvaluationCache(std::shared_ptr<EvaluationCache> cache)
+    {
+        cache_ = std::move(cache);
+    }
+
+    std::shared_ptr<EvaluationCache> Optimizer::evaluationCache() const
+    {
+        return cache_;
+    }
+
+    std::uint64_t Optimizer::cacheHits() const
+    {
+        return cacheHits_.load();
+    }
+
+    std::uint64_t Optimizer::cacheMisses() const
+    {
+        return cacheMisses_.load();
+    }
+
+    void Optimizer::setMetricsEnabled(bool enabled)
+    {
+        metricsEnabled_ = enabled;
+    }
+
+    bool Optimizer::metricsEnabled() const
+    {
+        return metricsEnabled_;
+    }
+
+    OptimizerMetrics Optimizer::metrics() const
+    {
+        std::lock_guard<std::mutex> lock(metricsMutex_);
+        return metrics_;
+    }
+
+    void Optimizer::resetMetrics()
+    {
+        std::lock_guard<std::mutex> lock(metricsMutex_);
+        metrics_ = OptimizerMetrics();
+    }
+
+    std::string Optimizer::metricsJson() const
+    {
+        return metrics().toJson();
+    }
+
+    void Optimizer::setSearchMethod(SearchMethod method)
+    {
+        if (method != searchMethod_)
+        {
+            searchMethod_ = method;
+            strategy_.reset();
+        }
+    }
+
+    SearchMethod Optimizer::searchMethod() const
+    {
+        return searchMethod_;
+    }
+
+    Optimizer::ParameterBounds Optimizer::defaultBounds()
+    {
+        // +-20% around the nominal vehicle and guidance parameters
+        return {
+            {16000.0, 160000.0, 400.0, 480.0, 14000.0, 0.55},
+            {24000.0, 240000.0, 600.0, 720.0, 16000.0, 0.75}};
+    }
+
+    void Optimizer::setBounds(const ParameterBounds &bounds)
+    {
+        for (auto field : PARAMETER_FIELDS)
+        {
+            if (!(bounds.lower.*field <= bounds.upper.*field))
+            {
+                throw std::invalid_argument("Optimizer bounds: lower bound exceeds upper bound");
+            }
+        }
+        bounds_ = bounds;
+        strategy_.reset();
+    }
+
+    const Optimizer::ParameterBounds &Optimizer::bounds() const
+    {
+        return bounds_;
+    }
+
+    Optimizer::OptimizedParameters Optimizer::toParameters(const ParameterSampler::Point &u) const
+    {
+        OptimizedParameters params;
+        for (std::size_t d = 0; d < PARAMETER_FIELDS.size(); ++d)
+        {
+            auto field = PARAMETER_FIELDS[d];
+            params.*field = bounds_.lower.*field + (bounds_.upper.*field - bounds_.lower.*field) * u[d];
+        }
+        return params;
+    }
+
+    Optimizer::OptimizedParameters Optimizer::generateRandomParameters(std::uint64_t index) const
+    {
+        return toParameters(sampler_->sample(index));
+    }
+
+    std::unique_ptr<Simulator> Optimizer::makeSimulator(const OptimizedParameters &params,
+                                                        std::shared_ptr<GravityTurnAutopilot> autopilot,
+                                                        double pruningBound, bool metrics) const
+    {
+        auto rocket = std::make_shared<Rocket>(buildRocket(params));
+        auto sim = std::make_unique<Simulator>(rocket, env_, destination_, std::move(autopilot));
+        configureSimulator(*sim, pruningBound, metrics);
+        return sim;
+    }
+
+    void Optimizer::configureSimulator(SimulatorBase &sim, double pruningBound, bool metrics) const
+    {
+        sim.setPruningBound(pruningBound);
+        sim.setRecedingPruning(pruning_ == PruningMode::Aggressive);
+        sim.setIntegrator(integrator_);
+        sim.setMetricsEnabled(metrics);
+    }
+
+    double Optimizer::evaluateParameters(const OptimizedParameters &params, double pruningBound,
+                                         OptimizerMetrics *metrics, const SharedAscent *ascent,
+                                         EvaluationCache::BoundRange *range)
+    {
+        Rocket rocket = buildRocket(params);
+        GravityTurnAutopilot autopilot = ascent ? ascent->autopilotFor(params) : buildAutopilot(params, borrow(*env_));
+
+        GravityTurnSimulator sim(rocket, *env_, destination_, &autopilot);
+        configureSimulator(sim, pruningBound, metrics != nullptr);
+        if (ascent)
+        {
+            // Settings as the ascent's, which makeSimulator set up the same way
+            sim.restore(*ascent->snapshot, &autopilot);
+        }
+        sim.run(timeStep_);
+
+        if (metrics)
+        {
+            metrics->simulation.merge(sim.metrics());
+        }
+        return finishRun(sim, rocket, metrics, range);
+    }
+
+    double Optimizer::evaluate(const OptimizedParameters &params)
+    {
+        Logger::ScopedMute mute;
+        return evaluateParameters(params, pruningBound());
+    }
+
+    double Optimizer::finishRun(const SimulatorBase &sim, const Rocket &rocket, OptimizerMetrics *metrics,
+                                EvaluationCache::BoundRange *range)
+    {
+        evaluationCount_.fetch_add(1, std::memory_order_relaxed);
+        if (metrics)
+        {
+            metrics->addRun(static_cast<std::size_t>(sim.terminationReason()), sim.stepCount());
+        }
+
+        // A run only scores the same under bounds that let the same checks pass
+        if (range)
+        {
+            *range = {sim.pruningPeak(), std::numeric_limits<double>::infinity()};
+        }
+
+        // A pruned run scores infinity. The estimate that stopped it is only a lower
+        // bound, and a search ranking candidates by it would go where pruning is mild.
+        if (sim.terminationReason() == Simulator::TerminationReason::Pruned)
+        {
+            prunedCount_.fetch_add(1, std::memory_order_relaxed);
+            if (range)
+            {
+                range->high = sim.prunedDistance();
+            }
+            return std::numeric_limits<double>::infinity();
+        }
+        return score(rocket.position(), rocket.totalMass() - rocket.dryMass());
+    }
+
     std::shared_ptr<Rocket> Optimizer::getBestRocket() const
     {
-        return bestRocket_;
+        auto params = bestParameters();
+        return params ? std::make_shared<Rocket>(buildRocket(*params)) : nullptr;
     }
 
     std::shared_ptr<GravityTurnAutopilot> Optimizer::getBestAutopilot() const
     {
-        return bestAutopilot_;
+        auto params = bestParameters();
+        return params ? std::make_shared<GravityTurnAutopilot>(buildAutopilot(*params, env_)) : nullptr;
     }
 
     double Optimizer::getBestScore() const
     {
+        std::lock_guard<std::mutex> lock(bestMutex_);
         return bestScore_;
     }
 
+    std::pair<std::shared_ptr<Rocket>, std::shared_ptr<GravityTurnAutopilot>> Optimizer::bestVehicle() const
+    {
+        auto params = bestParameters();
+        if (!params)
+        {
+            return {};
+        }
+        return {std::make_shared<Rocket>(buildRocket(*params)),
+                std::make_shared<GravityTurnAutopilot>(buildAutopilot(*params, env_))};
+    }
+
+    std::optional<Optimizer::OptimizedParameters> Optimizer::bestParameters() const
+    {
+        std::lock_guard<std::mutex> lock(bestMutex_);
+        if (!hasBest_)
+        {
+            return std::nullopt;
+        }
+        return bestParameters_;
+    }
+
+    Optimizer::OptimizedParameters Optimizer::getOptimizedParameters() const
+    {
+        std::lock_guard<std::mutex> lock(bestMutex_);
+        return bestParameters_;
+    }
+
     std::shared_ptr<Simulator> Optimizer::createOptimizedSimulator()
     {
-        auto env = std::make_shared<Environment>();
-        auto rocket = std::make_shared<Rocket>(
-            bestRocket_->dryMass(),
-            bestRocket_->fuelMass(),
-            bestRocket_->burnRate(),
-            bestRocket_->specificImpulse(),
-            bestRocket_->getCrossSectionArea(),
-            bestRocket_->getDragCoefficient());
-        auto autopilot = std::make_shared<GravityTurnAutopilot>(
-            bestAutopilot_->targetAltitude(),
-            destination_,
-            env,
-            bestAutopilot_->turnStartAltitude(),
-            bestAutopilot_->turnRate(),
-            bestAutopilot_->maxAngularVelocity());
-
-        return std::make_shared<Simulator>(rocket, env, destination_, autopilot);
+        auto params = bestParameters();
+        if (!params)
+        {
+            return nullptr;
+        }
+
+        // The whole environment (model and density scale), so the replay flies the
+        // atmosphere the candidate was scored in without sharing env_
+        auto env = std::make_shared<Environment>(*env_);
+        auto rocket = std::make_shared<Rocket>(buildRocket(*params));
+        auto autopilot = std::make_shared<GravityTurnAutopilot>(buildAutopilot(*params, env));
+
+        auto simulator = std::make_shared<Simulator>(rocket, env, destination_, autopilot);
+        configureSimulator(*simulator, std::numeric_limits<double>::infinity(), false);
+        simulator->setTimeStep(timeStep_);
+        return simulator;
     }
 
     std::string Optimizer::toJson() const
     {
+        auto params = bestParameters();
+        if (!params)
+        {
+            return "null";
+        }
         return "{"
                "\"dryMass\":" +
-               std::to_string(bestRocket_->dryMass()) + ","
-                                                        "\"initialFuel\":" +
-               std::to_string(bestRocket_->fuelMass()) + ","
-                                                         "\"burnRate\":" +
-               std::to_string(bestRocket_->burnRate()) + ","
-                                                         "\"specificImpulse\":" +
-               std::to_string(bestRocket_->specificImpulse()) + ","
-                                                                "\"turnStartAltitude\":" +
-               std::to_string(bestAutopilot_->turnStartAltitude()) + ","
-                                                                     "\"turnRate\":" +
-               std::to_string(bestAutopilot_->turnRate()) +
+               std::to_string(params->dryMass) + ","
+                                                 "\"initialFuel\":" +
+               std::to_string(params->initialFuel) + ","
+                                                     "\"burnRate\":" +
+               std::to_string(params->burnRate) + ","
+                                                  "\"specificImpulse\":" +
+               std::to_string(params->specificImpulse) + ","
+                                                         "\"turnStartAltitude\":" +
+               std::to_string(params->turnStartAltitude) + ","
+                                                           "\"turnRate\":" +
+               std::to_string(params->turnRate) +
                "}";
     }
 
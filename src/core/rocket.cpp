@@ -38,12 +38,36 @@ namespace sim::core
         Vector3 acceleration = totalForce / totalMass();
         velocity_ += acceleration * dt;
         position_ += velocity_ * dt;
-        double r = position_.length();
+        clampToGround();
+    }
+
+    void Rocket::setState(const Vector3 &position, const Vector3 &velocity, double fuelMass)
+    {
+        bool wasBurning = fuelMass_ > 0 && currentThrust_ > 0;
+
+        position_ = position;
+        velocity_ = velocity;
+        fuelMass_ = std::max(0.0, fuelMass);
+
+        if (wasBurning && fuelMass_ <= 0)
+        {
+            currentThrust_ = 0;
+            thrustLevel_ = 0;
+            Logger::warning("Fuel exhausted!");
+        }
+
+        clampToGround();
+    }
+
+    void Rocket::clampToGround()
+    {
+        double r;
+        Vector3 up = position_.normalizedWithLength(r);
         double altitude = r - config::EARTH_RADIUS;
 
         if (altitude < 0)
         {
-            position_ = position_.normalized() * config::EARTH_RADIUS;
+            position_ = up * config::EARTH_RADIUS;
             Vector3 radialDir = position_.normalized();
             double radialSpeed = velocity_.dot(radialDir);
 
@@ -53,14 +77,6 @@ namespace sim::core
                 velocity_ = velocity_ - radialDir * radialSpeed;
             }
         }
-        // Logger::debug("Position: (" + std::to_string(position_.x()) + ", " +
-        //               std::to_string(position_.y()) + ", " + std::to_string(position_.z()) +
-        //               "), Altitude: " + std::to_string(altitude));
-    }
-
-    bool Rocket::isOutOfFuel() const
-    {
-        return fuelMass_ <= 0;
     }
 
     void Rocket::setThrust(const Vector3 &desiredDirection, double maxAnglePerStep)
@@ -80,56 +96,6 @@ namespace sim::core
         thrustDirection_ = newDirection.normalized();
     }
 
-    double Rocket::totalMass() const
-    {
-        return dryMass_ + fuelMass_;
-    }
-
-    double Rocket::dryMass() const
-    {
-        return dryMass_;
-    }
-
-    double Rocket::fuelMass() const
-    {
-        return fuelMass_;
-    }
-
-    double Rocket::getCrossSectionArea() const
-    {
-        return crossSectionArea_;
-    }
-
-    double Rocket::getDragCoefficient() const
-    {
-        return dragCoefficient_;
-    }
-
-    Vector3 Rocket::position() const
-    {
-        return position_;
-    }
-
-    Vector3 Rocket::velocity() const
-    {
-        return velocity_;
-    }
-
-    Vector3 Rocket::thrust() const
-    {
-        return thrustDirection_ * currentThrust_;
-    }
-
-    void Rocket::setPosition(const Vector3 &position)
-    {
-        position_ = position;
-    }
-
-    void Rocket::setVelocity(const Vector3 &velocity)
-    {
-        velocity_ = velocity;
-    }
-
     void Rocket::setThrustLevel(double level)
     {
         if (isOutOfFuel())
@@ -143,21 +109,6 @@ namespace sim::core
         currentThrust_ = thrustLevel_ * specificImpulse_ * config::g * burnRate_;
     }
 
-    double Rocket::thrustLevel() const
-    {
-        return thrustLevel_;
-    }
-
-    double Rocket::specificImpulse() const
-    {
-        return specificImpulse_;
-    }
-
-    double Rocket::burnRate() const
-    {
-        return burnRate_;
-    }
-
     std::string Rocket::toJson() const
     {
         return "{"
@@ -0,0 +1,177 @@
+#include "../../include/core/sampler.hpp"
+#include "../../include/utils/random.hpp"
+#include <stdexcept>
+
+using sim::utils::CounterRng;
+using sim::utils::hashCombine;
+
+namespace sim::core
+{
+
+    namespace
+    {
+        struct SobolPolynomial
+        {
+            int degree;
+            std::uint32_t coefficients;
+            std::array<std::uint32_t, 4> initial;
+        };
+
+        // new-joe-kuo-6.21201, dimensions 2..6 (dimension 1 is the van der Corput sequence)
+        constexpr SobolPolynomial SOBOL_POLYNOMIALS[] = {
+            {1, 0, {1, 0, 0, 0}},
+            {2, 1, {1, 3, 0, 0}},
+            {3, 1, {1, 3, 1, 0}},
+            {3, 2, {1, 1, 1, 0}},
+            {4, 1, {1, 1, 3, 3}},
+        };
+
+        constexpr double TO_UNIT_32 = 1.0 / 4294967296.0;
+
+        // Kensler, "Correlated Multi-Jittered Sampling": keyed permutation of [0, length)
+        std::uint32_t permute(std::uint32_t i, std::uint32_t length, std::uint32_t key)
+        {
+            std::uint32_t w = length - 1;
+            w |= w >> 1;
+            w |= w >> 2;
+            w |= w >> 4;
+            w |= w >> 8;
+            w |= w >> 16;
+
+            do
+            {
+                i ^= key;
+                i *= 0xe170893d;
+                i ^= key >> 16;
+                i ^= (i & w) >> 4;
+                i ^= key >> 8;
+                i *= 0x0929eb3f;
+                i ^= key >> 23;
+                i ^= (i & w) >> 1;
+                i *= 1 | key >> 27;
+                i *= 0x6935fa69;
+                i ^= (i & w) >> 11;
+                i *= 0x74dcb303;
+                i ^= (i & w) >> 2;
+                i *= 0x9e501cc3;
+                i ^= (i & w) >> 2;
+                i *= 0xc860a3df;
+                i &= w;
+                i ^= i >> 5;
+            } while (i >= length);
+
+            return (i + key) % length;
+        }
+    }
+
+    RandomSampler::RandomSampler(std::uint64_t seed) : seed_(seed) {}
+
+    ParameterSampler::Point RandomSampler::sample(std::uint64_t index) const
+    {
+        CounterRng rng(seed_, index);
+        Point point;
+        for (auto &value : point)
+        {
+            value = rng.uniform();
+        }
+        return point;
+    }
+
+    SobolSampler::SobolSampler(std::uint64_t seed)
+    {
+        for (int bit = 0; bit < BITS; ++bit)
+        {
+            directions_[0][bit] = 1u << (BITS - 1 - bit);
+        }
+
+        for (std::size_t d = 1; d < DIMENSIONS; ++d)
+        {
+            const SobolPolynomial &poly = SOBOL_POLYNOMIALS[d - 1];
+            auto &v = directions_[d];
+            int s = poly.degree;
+
+            for (int bit = 0; bit < s; ++bit)
+            {
+                v[bit] = poly.initial[bit] << (BITS - 1 - bit);
+            }
+
+            for (int bit = s; bit < BITS; ++bit)
+            {
+                v[bit] = v[bit - s] ^ (v[bit - s] >> s);
+                for (int k = 1; k < s; ++k)
+                {
+                    if ((poly.coefficients >> (s - 1 - k)) & 1u)
+                    {
+                        v[bit] ^= v[bit - k];
+                    }
+                }
+            }
+        }
+
+        CounterRng rng(seed, 0);
+        for (auto &shift : shift_)
+        {
+            shift = static_cast<std::uint32_t>(rng.next() >> 32);
+        }
+    }
+
+    ParameterSampler::Point SobolSampler::sample(std::uint64_t index) const
+    {
+        Point point;
+        for (std::size_t d = 0; d < DIMENSIONS; ++d)
+        {
+            std::uint32_t x = shift_[d];
+            std::uint64_t n = index;
+            for (int bit = 0; n != 0 && bit < BITS; ++bit, n >>= 1)
+            {
+                if (n & 1u)
+                {
+                    x ^= directions_[d][bit];
+                }
+            }
+            point[d] = x * TO_UNIT_32;
+        }
+        return point;
+    }
+
+    LatinHypercubeSampler::LatinHypercubeSampler(std::uint64_t seed, std::uint32_t strata)
+        : seed_(seed), strata_(strata)
+    {
+        if (strata_ == 0)
+        {
+            throw std::invalid_argument("Latin hypercube needs at least one stratum");
+        }
+    }
+
+    ParameterSampler::Point LatinHypercubeSampler::sample(std::uint64_t index) const
+    {
+        std::uint64_t block = index / strata_;
+        std::uint32_t position = static_cast<std::uint32_t>(index % strata_);
+
+        CounterRng jitter(seed_, index);
+        Point point;
+        for (std::size_t d = 0; d < DIMENSIONS; ++d)
+        {
+            auto key = static_cast<std::uint32_t>(hashCombine(hashCombine(seed_, block), d));
+            std::uint32_t stratum = permute(position, strata_, key);
+            point[d] = (stratum + jitter.uniform()) / strata_;
+        }
+        return point;
+    }
+
+    std::shared_ptr<ParameterSampler> makeSampler(SamplerType type, std::uint64_t seed,
+                                                  std::uint32_t sampleCount)
+    {
+        switch (type)
+        {
+        case SamplerType::Random:
+            return std::make_shared<RandomSampler>(seed);
+        case SamplerType::Sobol:
+            return std::make_shared<SobolSampler>(seed);
+        case SamplerType::LatinHypercube:
+            return std::make_shared<LatinHypercubeSampler>(seed, sampleCount == 0 ? 1 : sampleCount);
+        }
+        throw std::invalid_argument("Unknown sampler type");
+    }
+
+} // namespace sim::core
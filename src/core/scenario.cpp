@@ -0,0 +1,288 @@
+#include "../../include/core/scenario.hpp"
+#include <array>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace sim::core
+{
+
+    namespace
+    {
+        const std::array<std::pair<const char *, EnvironmentModel>, 3> ENVIRONMENT_NAMES = {{
+            {"analytic", EnvironmentModel::Analytic},
+            {"tabulated_exponential", EnvironmentModel::TabulatedExponential},
+            {"standard_atmosphere_1976", EnvironmentModel::StandardAtmosphere1976},
+        }};
+
+        const std::array<std::pair<const char *, SearchMethod>, 3> SEARCH_NAMES = {{
+            {"random", SearchMethod::RandomSampling},
+            {"differential_evolution", SearchMethod::DifferentialEvolution},
+            {"cma_es", SearchMethod::CmaEs},
+        }};
+
+        const std::array<std::pair<const char *, SamplerType>, 3> SAMPLER_NAMES = {{
+            {"random", SamplerType::Random},
+            {"sobol", SamplerType::Sobol},
+            {"latin_hypercube", SamplerType::LatinHypercube},
+        }};
+
+        // Names of Optimizer::PARAMETER_FIELDS, as in Optimizer::toJson
+        const std::array<const char *, ParameterSampler::DIMENSIONS> FIELD_NAMES = {
+            "dryMass", "initialFuel", "burnRate", "specificImpulse", "turnStartAltitude", "turnRate"};
+
+        template <typename Enum, std::size_t N>
+        const char *nameOf(const std::array<std::pair<const char *, Enum>, N> &names, Enum value)
+        {
+            for (const auto &[name, candidate] : names)
+            {
+                if (candidate == value)
+                {
+                    return name;
+                }
+            }
+            return "unknown";
+        }
+
+        std::string trim(const std::string &text)
+        {
+            std::size_t begin = 0;
+            std::size_t end = text.size();
+            while (begin < end && std::isspace(static_cast<unsigned char>(text[begin])))
+            {
+                ++begin;
+            }
+            while (end > begin && std::isspace(static_cast<unsigned char>(text[end - 1])))
+            {
+                --end;
+            }
+            return text.substr(begin, end - begin);
+        }
+
+        class Parser
+        {
+        private:
+            std::string source_;
+            int line_ = 0;
+
+        public:
+            explicit Parser(std::string source) : source_(std::move(source)) {}
+
+            void setLine(int line) { line_ = line; }
+
+            [[noreturn]] void fail(const std::string &message) const
+            {
+                throw std::runtime_error(source_ + ":" + std::to_string(line_) + ": " + message);
+            }
+
+            // Exactly `count` numbers, nothing else
+            std::vector<double> numbers(const std::string &key, const std::string &value, std::size_t count) const
+            {
+                std::istringstream in(value);
+                std::vector<double> result;
+                double number;
+                while (in >> number)
+                {
+                    result.push_back(number);
+                }
+                if (!in.eof() || result.size() != count)
+                {
+                    fail(key + " needs " + std::to_string(count) + " number(s), got \"" + value + "\"");
+                }
+                return result;
+            }
+
+            template <typename Enum, std::size_t N>
+            Enum choice(const std::string &key, const std::string &value,
+                        const std::array<std::pair<const char *, Enum>, N> &names) const
+            {
+                std::string allowed;
+                for (const auto &[name, candidate] : names)
+                {
+                    if (value == name)
+                    {
+                        return candidate;
+                    }
+                    allowed += (allowed.empty() ? "" : ", ") + std::string(name);
+                }
+                fail("unknown " + key + " \"" + value + "\" (expected " + allowed + ")");
+            }
+
+            void apply(Scenario &scenario, bool &hasDestination, const std::string &key, const std::string &value) const
+            {
+                if (key == "destination")
+                {
+                    auto xyz = numbers(key, value, 3);
+                    scenario.destination = Vector3(xyz[0], xyz[1] + sim::utils::config::EARTH_RADIUS, xyz[2]);
+                    hasDestination = true;
+                }
+                else if (key == "iterations")
+                {
+                    double iterations = numbers(key, value, 1)[0];
+                    if (!(iterations >= 1.0 && iterations <= 1e9) || iterations != static_cast<int>(iterations))
+                    {
+                        fail("iterations must be a positive integer");
+                    }
+                    scenario.iterations = static_cast<int>(iterations);
+                }
+                else if (key == "time_step")
+                {
+                    scenario.timeStep = numbers(key, value, 1)[0];
+                    if (!(scenario.timeStep > 0.0))
+                    {
+                        fail("time_step must be positive");
+                    }
+                }
+                else if (key == "seed")
+                {
+                    std::istringstream in(value);
+                    if (value.empty() || value.front() == '-' || !(in >> scenario.seed) || !(in >> std::ws).eof())
+                    {
+                        fail("seed must be a non-negative integer");
+                    }
+                }
+                else if (key == "environment")
+                {
+                    scenario.environment = choice(key, value, ENVIRONMENT_NAMES);
+                }
+                else if (key == "search")
+                {
+                    scenario.search = choice(key, value, SEARCH_NAMES);
+                }
+                else if (key == "sampler")
+                {
+                    scenario.sampler = choice(key, value, SAMPLER_NAMES);
+                }
+                else if (key.rfind("bounds.", 0) == 0)
+                {
+                    std::string field = key.substr(7);
+                    for (std::size_t i = 0; i < FIELD_NAMES.size(); ++i)
+                    {
+                        if (field == FIELD_NAMES[i])
+                        {
+                            auto range = numbers(key, value, 2);
+                            if (!(range[0] <= range[1]))
+                            {
+                                fail(key + ": lower bound exceeds upper bound");
+                            }
+                            scenario.bounds.lower.*Optimizer::PARAMETER_FIELDS[i] = range[0];
+                            scenario.bounds.upper.*Optimizer::PARAMETER_FIELDS[i] = range[1];
+                            return;
+                        }
+                    }
+                    fail("unknown parameter \"" + field + "\"");
+                }
+                else
+                {
+                    fail("unknown key \"" + key + "\"");
+                }
+            }
+        };
+    }
+
+    void Scenario::configure(Optimizer &optimizer) const
+    {
+        optimizer.setTimeStep(timeStep);
+        optimizer.setSearchMethod(search);
+        optimizer.setSampler(sampler);
+        optimizer.setBounds(bounds);
+    }
+
+    std::vector<Scenario> parseScenarios(std::istream &in, const std::string &source)
+    {
+        Parser parser(source);
+        Scenario defaults;
+        bool defaultDestination = false;
+
+        std::vector<Scenario> scenarios;
+        std::vector<bool> hasDestination;
+        std::vector<int> sectionLines;
+
+        std::string text;
+        int line = 0;
+        while (std::getline(in, text))
+        {
+            parser.setLine(++line);
+            text = trim(text.substr(0, text.find('#')));
+            if (text.empty())
+            {
+                continue;
+            }
+
+            if (text.front() == '[')
+            {
+                if (text.back() != ']')
+                {
+                    parser.fail("unterminated section header");
+                }
+                Scenario scenario = defaults;
+                scenario.name = trim(text.substr(1, text.size() - 2));
+                if (scenario.name.empty())
+                {
+                    parser.fail("empty scenario name");
+                }
+                scenarios.push_back(scenario);
+                hasDestination.push_back(defaultDestination);
+                sectionLines.push_back(line);
+                continue;
+            }
+
+            std::size_t equals = text.find('=');
+            if (equals == std::string::npos)
+            {
+                parser.fail("expected key = value");
+            }
+            std::string key = trim(text.substr(0, equals));
+            std::string value = trim(text.substr(equals + 1));
+            if (scenarios.empty())
+            {
+                parser.apply(defaults, defaultDestination, key, value);
+            }
+            else
+            {
+                // vector<bool> has no references to hand out
+                bool destination = hasDestination.back();
+                parser.apply(scenarios.back(), destination, key, value);
+                hasDestination.back() = destination;
+            }
+        }
+
+        for (std::size_t i = 0; i < scenarios.size(); ++i)
+        {
+            if (!hasDestination[i])
+            {
+                parser.setLine(sectionLines[i]);
+                parser.fail("scenario \"" + scenarios[i].name + "\" has no destination");
+            }
+        }
+        return scenarios;
+    }
+
+    std::vector<Scenario> loadScenarios(const std::string &path)
+    {
+        std::ifstream in(path);
+        if (!in)
+        {
+            throw std::runtime_error("Cannot open scenario file: " + path);
+        }
+        return parseScenarios(in, path);
+    }
+
+    const char *toString(EnvironmentModel model)
+    {
+        return nameOf(ENVIRONMENT_NAMES, model);
+    }
+
+    const char *toString(SearchMethod method)
+    {
+        return nameOf(SEARCH_NAMES, method);
+    }
+
+    const char *toString(SamplerType type)
+    {
+        return nameOf(SAMPLER_NAMES, type);
+    }
+
+} // namespace sim::core
@@ -0,0 +1,206 @@
+#include "../../include/core/scenario_runner.hpp"
+#include "../../include/core/environment.hpp"
+#include "../../include/utils/config.hpp"
+#include "../../include/utils/logger.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+
+using sim::utils::Logger;
+using sim::utils::ThreadPool;
+namespace config = sim::utils::config;
+
+namespace sim::core
+{
+
+    namespace
+    {
+        std::string jsonString(const std::string &text)
+        {
+            std::string out = "\"";
+            for (char c : text)
+            {
+                if (c == '"' || c == '\\')
+                {
+                    out += '\\';
+                    out += c;
+                }
+                else if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    char escape[8];
+                    std::snprintf(escape, sizeof(escape), "\\u%04x", static_cast<unsigned>(c));
+                    out += escape;
+                }
+                else
+                {
+                    out += c;
+                }
+            }
+            return out + "\"";
+        }
+
+        std::string csvField(const std::string &text)
+        {
+            if (text.find_first_of(",\"\r\n") == std::string::npos)
+            {
+                return text;
+            }
+            std::string out = "\"";
+            for (char c : text)
+            {
+                out += c;
+                if (c == '"')
+                {
+                    out += '"';
+                }
+            }
+            return out + "\"";
+        }
+    }
+
+    void ScenarioRunner::setJobs(unsigned jobs)
+    {
+        if (jobs != jobs_)
+        {
+            jobs_ = jobs;
+            pool_.reset();
+        }
+    }
+
+    unsigned ScenarioRunner::jobs() const
+    {
+        return jobs_ == 0 ? static_cast<unsigned>(ThreadPool::defaultThreadCount()) : jobs_;
+    }
+
+    void ScenarioRunner::setEvaluationCache(std::shared_ptr<EvaluationCache> cache)
+    {
+        cache_ = std::move(cache);
+    }
+
+    void ScenarioRunner::run(const std::vector<Scenario> &scenarios, const ResultCallback &onResult)
+    {
+        if (!pool_)
+        {
+            pool_ = std::make_shared<ThreadPool>(jobs_);
+        }
+
+        std::mutex resultMutex;
+        std::atomic<std::uint64_t> evaluations{0};
+        auto start = std::chrono::steady_clock::now();
+
+        auto runOne = [&](std::size_t index)
+        {
+            const Scenario &scenario = scenarios[index];
+            auto scenarioStart = std::chrono::steady_clock::now();
+
+            Optimizer optimizer(std::make_shared<Environment>(scenario.environment), scenario.destination, scenario.seed);
+            optimizer.setThreadPool(pool_);
+            // Each scenario reports through its record
+            optimizer.setSummaryLogging(false);
+            optimizer.setEvaluationCache(cache_);
+            scenario.configure(optimizer);
+            optimizer.optimize(scenario.iterations);
+
+            Result result;
+            result.index = index;
+            result.scenario = &scenario;
+            result.bestScore = optimizer.getBestScore();
+            result.parameters = optimizer.bestParameters();
+            result.evaluations = optimizer.evaluationCount();
+            result.pruned = optimizer.prunedCount();
+            result.cacheHits = optimizer.cacheHits();
+            result.cacheMisses = optimizer.cacheMisses();
+            result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - scenarioStart).count();
+            evaluations.fetch_add(result.evaluations, std::memory_order_relaxed);
+
+            std::lock_guard<std::mutex> lock(resultMutex);
+            onResult(result);
+        };
+        pool_->parallelFor(scenarios.size(), runOne);
+
+        Logger::info("ScenarioRunner: ", scenarios.size(), " scenarios, ", evaluations.load(), " evaluations in ",
+                     std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(),
+                     " s on ", pool_->size(), " threads");
+    }
+
+    void ScenarioRunner::run(const std::vector<Scenario> &scenarios, std::ostream &out, Format format)
+    {
+        if (format == Format::Csv)
+        {
+            out << csvHeader() << '\n';
+            out.flush();
+        }
+
+        auto write = [&](const Result &result)
+        {
+            out << (format == Format::Csv ? toCsv(result) : toJson(result)) << '\n';
+            out.flush();
+        };
+        run(scenarios, write);
+    }
+
+    std::string ScenarioRunner::toJson(const Result &result)
+    {
+        const Scenario &scenario = *result.scenario;
+        std::string json = "{\"index\":" + std::to_string(result.index) +
+                           ",\"name\":" + jsonString(scenario.name) +
+                           ",\"destination\":[" + std::to_string(scenario.destination.x()) + "," +
+                           std::to_string(scenario.destination.y() - config::EARTH_RADIUS) + "," +
+                           std::to_string(scenario.destination.z()) + "]" +
+                           ",\"environment\":\"" + toString(scenario.environment) + "\"" +
+                           ",\"search\":\"" + toString(scenario.search) + "\"" +
+                           ",\"timeStep\":" + std::to_string(scenario.timeStep) +
+                           ",\"iterations\":" + std::to_string(scenario.iterations) +
+                           ",\"evaluations\":" + std::to_string(result.evaluations) +
+                           ",\"pruned\":" + std::to_string(result.pruned) +
+                           ",\"cacheHits\":" + std::to_string(result.cacheHits) +
+                           ",\"cacheMisses\":" + std::to_string(result.cacheMisses) +
+                           ",\"wallSeconds\":" + std::to_string(result.wallSeconds);
+        if (!result.parameters)
+        {
+            return json + ",\"bestScore\":null,\"parameters\":null}";
+        }
+
+        const auto &p = *result.parameters;
+        return json + ",\"bestScore\":" + std::to_string(result.bestScore) +
+               ",\"parameters\":{\"dryMass\":" + std::to_string(p.dryMass) +
+               ",\"initialFuel\":" + std::to_string(p.initialFuel) +
+               ",\"burnRate\":" + std::to_string(p.burnRate) +
+               ",\"specificImpulse\":" + std::to_string(p.specificImpulse) +
+               ",\"turnStartAltitude\":" + std::to_string(p.turnStartAltitude) +
+               ",\"turnRate\":" + std::to_string(p.turnRate) + "}}";
+    }
+
+    std::string ScenarioRunner::csvHeader()
+    {
+        return "index,name,x,altitude,z,environment,search,timeStep,iterations,evaluations,pruned,cacheHits,cacheMisses,"
+               "wallSeconds,"
+               "bestScore,dryMass,initialFuel,burnRate,specificImpulse,turnStartAltitude,turnRate";
+    }
+
+    std::string ScenarioRunner::toCsv(const Result &result)
+    {
+        const Scenario &scenario = *result.scenario;
+        std::string row = std::to_string(result.index) + "," + csvField(scenario.name) + "," +
+                          std::to_string(scenario.destination.x()) + "," +
+                          std::to_string(scenario.destination.y() - config::EARTH_RADIUS) + "," +
+                          std::to_string(scenario.destination.z()) + "," +
+                          toString(scenario.environment) + "," + toString(scenario.search) + "," +
+                          std::to_string(scenario.timeStep) + "," + std::to_string(scenario.iterations) + "," +
+                          std::to_string(result.evaluations) + "," + std::to_string(result.pruned) + "," +
+                          std::to_string(result.cacheHits) + "," + std::to_string(result.cacheMisses) + "," +
+                          std::to_string(result.wallSeconds);
+        if (!result.parameters)
+        {
+            return row + ",,,,,,,";
+        }
+
+        const auto &p = *result.parameters;
+        return row + "," + std::to_string(result.bestScore) + "," +
+               std::to_string(p.dryMass) + "," + std::to_string(p.initialFuel) + "," +
+               std::to_string(p.burnRate) + "," + std::to_string(p.specificImpulse) + "," +
+               std::to_string(p.turnStartAltitude) + "," + std::to_string(p.turnRate);
+    }
+
+} // namespace sim::core
@@ -0,0 +1,396 @@
+#include "../../include/core/search_strategy.hpp"
+#include "../../include/utils/random.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+using sim::utils::CounterRng;
+using sim::utils::hashCombine;
+
+namespace sim::core
+{
+
+    namespace
+    {
+        constexpr std::size_t N = SearchStrategy::DIMENSIONS;
+
+        std::vector<std::size_t> rankByScore(const std::vector<double> &scores)
+        {
+            std::vector<std::size_t> order(scores.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&scores](std::size_t a, std::size_t b)
+                             { return scores[a] < scores[b]; });
+            return order;
+        }
+    }
+
+    // ---------------------------------------------------------------- Differential evolution
+
+    DifferentialEvolution::DifferentialEvolution(std::uint64_t seed,
+                                                 std::size_t populationSize,
+                                                 double differentialWeight,
+                                                 double crossoverRate)
+        : seed_(seed),
+          populationSize_(populationSize),
+          differentialWeight_(differentialWeight),
+          crossoverRate_(crossoverRate)
+    {
+        if (populationSize_ < 4)
+        {
+            throw std::invalid_argument("Differential evolution needs a population of at least 4");
+        }
+    }
+
+    void DifferentialEvolution::ask(std::vector<Point> &population)
+    {
+        population.resize(populationSize_);
+
+        if (population_.empty())
+        {
+            SobolSampler initial(seed_);
+            for (std::size_t i = 0; i < populationSize_; ++i)
+            {
+                population[i] = initial.sample(i);
+            }
+            return;
+        }
+
+        for (std::size_t i = 0; i < populationSize_; ++i)
+        {
+            CounterRng rng(seed_, hashCombine(generation_, i));
+
+            std::size_t r1, r2, r3;
+            do
+            {
+                r1 = rng.next() % populationSize_;
+            } while (r1 == i);
+            do
+            {
+                r2 = rng.next() % populationSize_;
+            } while (r2 == i || r2 == r1);
+            do
+            {
+                r3 = rng.next() % populationSize_;
+            } while (r3 == i || r3 == r1 || r3 == r2);
+
+            const Point &target = population_[i];
+            std::size_t forced = rng.next() % N;
+            Point trial = target;
+
+            for (std::size_t d = 0; d < N; ++d)
+            {
+                if (d != forced && rng.uniform() >= crossoverRate_)
+                {
+                    continue;
+                }
+
+                double value = population_[r1][d] +
+                               differentialWeight_ * (population_[r2][d] - population_[r3][d]);
+
+                // Out-of-range components land halfway between the target and the bound
+                if (value < 0.0)
+                {
+                    value = 0.5 * target[d];
+                }
+                else if (value > 1.0)
+                {
+                    value = 0.5 * (target[d] + 1.0);
+                }
+                trial[d] = value;
+            }
+
+            population[i] = trial;
+        }
+    }
+
+    void DifferentialEvolution::tell(const std::vector<Point> &population, const std::vector<double> &scores)
+    {
+        if (population.size() != populationSize_ || scores.size() != populationSize_)
+        {
+            return;
+        }
+
+        if (population_.empty())
+        {
+            population_ = population;
+            scores_ = scores;
+        }
+        else
+        {
+            for (std::size_t i = 0; i < populationSize_; ++i)
+            {
+                if (scores[i] <= scores_[i])
+                {
+                    population_[i] = population[i];
+                    scores_[i] = scores[i];
+                }
+            }
+        }
+        ++generation_;
+    }
+
+    double DifferentialEvolution::pruningBound(std::size_t index) const
+    {
+        // The first generation is kept whatever it scores
+        if (population_.empty() || index >= scores_.size())
+        {
+            return std::numeric_limits<double>::infinity();
+        }
+        return scores_[index];
+    }
+
+    // ---------------------------------------------------------------- CMA-ES
+
+    CmaEs::CmaEs(std::uint64_t seed, double initialSigma, std::size_t lambda)
+        : seed_(seed), initialSigma_(initialSigma)
+    {
+        const double n = static_cast<double>(N);
+
+        lambda_ = lambda != 0 ? lambda : 4 + static_cast<std::size_t>(std::floor(3.0 * std::log(n)));
+        mu_ = lambda_ / 2;
+
+        weights_.resize(mu_);
+        for (std::size_t i = 0; i < mu_; ++i)
+        {
+            weights_[i] = std::log(mu_ + 0.5) - std::log(i + 1.0);
+        }
+        double sum = std::accumulate(weights_.begin(), weights_.end(), 0.0);
+        double sumSquares = 0.0;
+        for (double &w : weights_)
+        {
+            w /= sum;
+            sumSquares += w * w;
+        }
+        mueff_ = 1.0 / sumSquares;
+
+        cc_ = (4.0 + mueff_ / n) / (n + 4.0 + 2.0 * mueff_ / n);
+        cs_ = (mueff_ + 2.0) / (n + mueff_ + 5.0);
+        c1_ = 2.0 / ((n + 1.3) * (n + 1.3) + mueff_);
+        cmu_ = std::min(1.0 - c1_, 2.0 * (mueff_ - 2.0 + 1.0 / mueff_) / ((n + 2.0) * (n + 2.0) + mueff_));
+        damps_ = 1.0 + 2.0 * std::max(0.0, std::sqrt((mueff_ - 1.0) / (n + 1.0)) - 1.0) + cs_;
+        chiN_ = std::sqrt(n) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+
+        restart();
+    }
+
+    void CmaEs::restart()
+    {
+        if (restarts_ == 0)
+        {
+            mean_.fill(0.5);
+        }
+        else
+        {
+            CounterRng rng(seed_, hashCombine(~0ULL, restarts_));
+            for (double &m : mean_)
+            {
+                m = rng.uniform();
+            }
+        }
+
+        sigma_ = initialSigma_;
+        pc_.fill(0.0);
+        ps_.fill(0.0);
+        D_.fill(1.0);
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            for (std::size_t j = 0; j < N; ++j)
+            {
+                C_[i][j] = B_[i][j] = (i == j) ? 1.0 : 0.0;
+            }
+        }
+        generation_ = 0;
+        ++restarts_;
+    }
+
+    void CmaEs::ask(std::vector<Point> &population)
+    {
+        population.resize(lambda_);
+
+        for (std::size_t k = 0; k < lambda_; ++k)
+        {
+            CounterRng rng(seed_, hashCombine(hashCombine(restarts_, generation_), k));
+
+            Point z;
+            for (double &value : z)
+            {
+                value = rng.normal();
+            }
+
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                double y = 0.0;
+                for (std::size_t j = 0; j < N; ++j)
+                {
+                    y += B_[i][j] * D_[j] * z[j];
+                }
+                population[k][i] = std::clamp(mean_[i] + sigma_ * y, 0.0, 1.0);
+            }
+        }
+    }
+
+    void CmaEs::tell(const std::vector<Point> &population, const std::vector<double> &scores)
+    {
+        if (population.size() != lambda_ || scores.size() != lambda_)
+        {
+            return;
+        }
+
+        std::vector<std::size_t> order = rankByScore(scores);
+
+        // Steps of the repaired (clamped) samples, so the update learns what was evaluated
+        std::vector<Point> steps(mu_);
+        Point oldMean = mean_;
+        mean_.fill(0.0);
+        for (std::size_t r = 0; r < mu_; ++r)
+        {
+            const Point &x = population[order[r]];
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                steps[r][i] = (x[i] - oldMean[i]) / sigma_;
+                mean_[i] += weights_[r] * x[i];
+            }
+        }
+
+        Point meanStep;
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            meanStep[i] = (mean_[i] - oldMean[i]) / sigma_;
+        }
+
+        // C^(-1/2) * meanStep = B * D^-1 * B^T * meanStep
+        Point projected{};
+        for (std::size_t j = 0; j < N; ++j)
+        {
+            double dot = 0.0;
+            for (std::size_t i = 0; i < N; ++i)
+            {
+                dot += B_[i][j] * meanStep[i];
+            }
+            projected[j] = dot / D_[j];
+        }
+
+        double psScale = std::sqrt(cs_ * (2.0 - cs_) * mueff_);
+        double psNorm = 0.0;
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            double value = 0.0;
+            for (std::size_t j = 0; j < N; ++j)
+            {
+                value += B_[i][j] * projected[j];
+            }
+            ps_[i] = (1.0 - cs_) * ps_[i] + psScale * value;
+            psNorm += ps_[i] * ps_[i];
+        }
+        psNorm = std::sqrt(psNorm);
+
+        double decay = 1.0 - std::pow(1.0 - cs_, 2.0 * (generation_ + 1));
+        bool hsig = psNorm / std::sqrt(decay) / chiN_ < 1.4 + 2.0 / (N + 1.0);
+
+        double pcScale = std::sqrt(cc_ * (2.0 - cc_) * mueff_);
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            pc_[i] = (1.0 - cc_) * pc_[i] + (hsig ? pcScale * meanStep[i] : 0.0);
+        }
+
+        double oldWeight = 1.0 - c1_ - cmu_ + (hsig ? 0.0 : c1_ * cc_ * (2.0 - cc_));
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            for (std::size_t j = 0; j <= i; ++j)
+            {
+                double rankMu = 0.0;
+                for (std::size_t r = 0; r < mu_; ++r)
+                {
+                    rankMu += weights_[r] * steps[r][i] * steps[r][j];
+                }
+                double value = oldWeight * C_[i][j] + c1_ * pc_[i] * pc_[j] + cmu_ * rankMu;
+                C_[i][j] = C_[j][i] = value;
+            }
+        }
+
+        sigma_ *= std::exp((cs_ / damps_) * (psNorm / chiN_ - 1.0));
+        ++generation_;
+
+        decompose();
+
+        double maxD = *std::max_element(D_.begin(), D_.end());
+        double minD = *std::min_element(D_.begin(), D_.end());
+        if (sigma_ * maxD < 1e-9 || !std::isfinite(sigma_) || maxD > 1e7 * minD)
+        {
+            restart();
+        }
+    }
+
+    void CmaEs::decompose()
+    {
+        // Cyclic Jacobi rotations; C is 6x6 so this is cheap next to one simulation
+        Matrix a = C_;
+        Matrix v{};
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            v[i][i] = 1.0;
+        }
+
+        for (int sweep = 0; sweep < 50; ++sweep)
+        {
+            double offDiagonal = 0.0;
+            for (std::size_t p = 0; p < N; ++p)
+            {
+                for (std::size_t q = p + 1; q < N; ++q)
+                {
+                    offDiagonal += a[p][q] * a[p][q];
+                }
+            }
+            if (offDiagonal < 1e-30)
+            {
+                break;
+            }
+
+            for (std::size_t p = 0; p < N; ++p)
+            {
+                for (std::size_t q = p + 1; q < N; ++q)
+                {
+                    if (std::abs(a[p][q]) < 1e-300)
+                    {
+                        continue;
+                    }
+
+                    double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+                    double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                    double c = 1.0 / std::sqrt(t * t + 1.0);
+                    double s = t * c;
+
+                    for (std::size_t k = 0; k < N; ++k)
+                    {
+                        double akp = a[k][p];
+                        double akq = a[k][q];
+                        a[k][p] = c * akp - s * akq;
+                        a[k][q] = s * akp + c * akq;
+                    }
+                    for (std::size_t k = 0; k < N; ++k)
+                    {
+                        double apk = a[p][k];
+                        double aqk = a[q][k];
+                        a[p][k] = c * apk - s * aqk;
+                        a[q][k] = s * apk + c * aqk;
+                    }
+                    for (std::size_t k = 0; k < N; ++k)
+                    {
+                        double vkp = v[k][p];
+                        double vkq = v[k][q];
+                        v[k][p] = c * vkp - s * vkq;
+                        v[k][q] = s * vkp + c * vkq;
+                    }
+                }
+            }
+        }
+
+        B_ = v;
+        for (std::size_t i = 0; i < N; ++i)
+        {
+            D_[i] = std::sqrt(std::max(a[i][i], 1e-300));
+        }
+    }
+
+} // namespace sim::core
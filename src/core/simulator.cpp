@@ -1,202 +1,150 @@
 #include "../../include/core/simulator.hpp"
-#include "../../include/core/environment.hpp"
-#include "../../include/utils/logger.hpp"
+#include <algorithm>
 #include <stdexcept>
-#include <cmath>
+#include <string>
 
 using namespace sim::utils;
 
 namespace sim::core
 {
 
-    Simulator::Simulator(std::shared_ptr<Rocket> rocket,
-                         std::shared_ptr<Environment> env,
-                         Vector3 destination,
-                         std::shared_ptr<Autopilot> autopilot)
-        : rocket_(rocket),
-          environment_(env),
-          autopilot_(autopilot),
-          time_(0.0),
-          destination_(destination)
+    namespace
     {
-        rocket_->setPosition(Vector3(0, sim::utils::config::EARTH_RADIUS + 1.0, 0));
-        // Logger::debug("Simulator initialized");
-        // Logger::debug("Rocket position: (" + std::to_string(rocket_->position().x()) + ", " + std::to_string(rocket_->position().y()) + ", " + std::to_string(rocket_->position().z()) + ")");
-        // Logger::debug("Destination: (" + std::to_string(destination_.x()) + ", " + std::to_string(destination_.y()) + ", " + std::to_string(destination_.z()) + ")");
+        template <typename T>
+        T &component(const std::shared_ptr<T> &pointer, const char *name)
+        {
+            if (!pointer)
+            {
+                throw std::invalid_argument(std::string("Simulator needs ") + name);
+            }
+            return *pointer;
+        }
     }
 
-    void Simulator::setDestination(const Vector3 &destination)
-    {
-        destination_ = destination;
-    }
+    // Every member of the flight loop is compiled here once for the Autopilot interface
+    template class BasicSimulator<Rocket, Autopilot, Environment>;
 
-    double Simulator::getCurrentDistance() const
+    Simulator::Simulator(std::shared_ptr<Rocket> rocket,
+                         std::shared_ptr<Environment> env,
+                         Vector3 destination,
+                         std::shared_ptr<Autopilot> autopilot)
+        : DynamicSimulator(component(rocket, "a rocket"), component(env, "an environment"),
+                           destination, autopilot.get()),
+          sharedRocket_(std::move(rocket)),
+          sharedEnvironment_(std::move(env)),
+          sharedAutopilot_(std::move(autopilot))
     {
-        return (rocket().position() - destination_).length();
     }
 
-    const Vector3 &Simulator::destination() const
+    void Simulator::setAutopilot(std::shared_ptr<Autopilot> autopilot)
     {
-        return destination_;
+        sharedAutopilot_ = std::move(autopilot);
+        autopilot_ = sharedAutopilot_.get();
     }
 
-    void Simulator::updateMinDistance(const double newMinDist)
-    {
-        minDistance_ = newMinDist;
-    }
+    static_assert(sizeof(Simulator::VisualSample) == Simulator::VISUAL_SAMPLE_FLOATS * sizeof(float),
+                  "VisualSample must be a plain run of floats");
 
-    bool Simulator::isArrived(double tolerance)
+    std::size_t Simulator::stepMany(std::size_t n, std::size_t stride, double dt)
     {
-        Vector3 rocketPos = rocket().position();
-        double distance = (rocketPos - destination_).length();
+        stride = std::max<std::size_t>(stride, 1);
+        samples_.clear();
+        samples_.reserve(n / stride + 1);
 
-        if (distance < minDistance_)
+        double scale = config::PHYSICS_TO_VISUAL_SCALE * 100;
+        auto sample = [&]
         {
-            minDistance_ = distance;
+            Rocket::RocketState state = rocket_->getState();
+            Vector3 position = state.position * scale;
+            auto f = [](double value)
+            { return static_cast<float>(value); };
+            samples_.push_back({f(time_),
+                                {f(position.x()), f(position.y()), f(position.z())},
+                                {f(state.velocity.x()), f(state.velocity.y()), f(state.velocity.z())},
+                                {f(state.thrustDirection.x()), f(state.thrustDirection.y()), f(state.thrustDirection.z())},
+                                f(state.fuelMass),
+                                f(state.thrustLevel),
+                                f(state.totalMass)});
+        };
+
+        // The checks of run() before each step; coasting and pruning are not played back
+        terminationReason_ = TerminationReason::None;
+        std::size_t steps = 0;
+        while (steps < n)
+        {
+            if (time_ >= MAX_SIMULATION_TIME)
+            {
+                terminationReason_ = TerminationReason::TimeLimit;
+            }
+            else if (rocket_->isOutOfFuel())
+            {
+                terminationReason_ = TerminationReason::OutOfFuel;
+            }
+            else if (isArrived())
+            {
+                terminationReason_ = TerminationReason::Arrived;
+            }
+            if (terminationReason_ != TerminationReason::None)
+            {
+                break;
+            }
+
+            step(dt);
+            if (++steps % stride == 0)
+            {
+                sample();
+            }
         }
 
-        if (distance < 2.0 * tolerance)
+        if (steps % stride != 0)
         {
-            wasClose_ = true;
+            sample();
         }
-
-        // Logger::debug("isArrived check: distance = " + std::to_string(distance) +
-        //               ", tolerance = " + std::to_string(tolerance) +
-        //               ", minDistance = " + std::to_string(minDistance_));
-
-        return wasClose_ && (distance > minDistance_) && (minDistance_ <= tolerance);
-    }
-
-    double Simulator::time() const
-    {
-        return time_;
-    }
-
-    const Rocket &Simulator::rocket() const
-    {
-        return *rocket_;
-    }
-
-    const Environment &Simulator::environment() const
-    {
-        return *environment_;
+        return steps;
     }
 
-    Vector3 Simulator::calculateTotalForce() const
+    const Simulator::VisualSample *Simulator::samples() const
     {
-        if (!rocket_ || !environment_)
-        {
-            throw std::runtime_error("Simulator not properly initialized");
-        }
-        Vector3 gForce = environment().computeGravityForce(rocket());
-        Vector3 dragForce = environment().computeDragForce(rocket());
-        Vector3 thrustForce = rocket().thrust();
-
-        Vector3 result = gForce + dragForce + thrustForce;
-        return result;
+        return samples_.data();
     }
 
-    void Simulator::updateRocketState(double dt, const Vector3 &acceleration)
+    std::size_t Simulator::sampleCount() const
     {
-        rocket_->setVelocity(rocket_->velocity() + acceleration * dt);
-        rocket_->setPosition(rocket_->position() + rocket_->velocity() * dt);
+        return samples_.size();
     }
 
-    void Simulator::step(double dt)
+    bool Simulator::runUntil(double dt, const std::function<bool(const Simulator &)> &pause)
     {
-        if (!rocket_ || !environment_)
-        {
-            throw std::runtime_error("Simulator not properly initialized");
-        }
-
-        Vector3 currentTotalForce = calculateTotalForce();
-
-        if (autopilot_)
+        auto paused = [this, &pause](const DynamicSimulator &)
         {
-            autopilot_->update(*rocket_, currentTotalForce, time_, dt);
-        }
-
-        Vector3 newTotalForce = calculateTotalForce();
-
-        rocket_->update(dt, newTotalForce);
-        time_ += dt;
-
-        // Logging
-        // std::string phaseStr;
-        // auto gravityAutopilot = std::dynamic_pointer_cast<GravityTurnAutopilot>(autopilot_);
-        // if (gravityAutopilot)
-        // {
-        //     switch (gravityAutopilot->currentPhase())
-        //     {
-        //     case GravityTurnAutopilot::Phase::VerticalAscent:
-        //         phaseStr = "VerticalAscent";
-        //         break;
-        //     case GravityTurnAutopilot::Phase::GravityTurn:
-        //         phaseStr = "GravityTurn";
-        //         break;
-        //     case GravityTurnAutopilot::Phase::TargetApproach:
-        //         phaseStr = "TargetApproach";
-        //         break;
-        //     }
-        // }
-
-        // Logger::info("Time: " + std::to_string(time_) +
-        //              ", Phase: " + phaseStr +
-        //              ", Position: (" + std::to_string(rocket_->position().x()) +
-        //              ", " + std::to_string(rocket_->position().y() - config::EARTH_RADIUS) +
-        //              ", " + std::to_string(rocket_->position().z()) +
-        //              "), Velocity: " + std::to_string(rocket_->velocity().length()) +
-        //              " m/s, Fuel: " + std::to_string(rocket_->totalMass() - rocket_->dryMass()) +
-        //              " kg");
-
-        // Logger::info("Time: " + std::to_string(time_) +
-        //              ", Phase: " + phaseStr +
-        //              ", Position: (" + std::to_string(rocket_->position().x()) +
-        //              ", " + std::to_string(rocket_->position().y()) +
-        //              ", " + std::to_string(rocket_->position().z()) +
-        //              "), Velocity: " + std::to_string(rocket_->velocity().length()) +
-        //              " m/s, Fuel: " + std::to_string(rocket_->totalMass() - rocket_->dryMass()) +
-        //              " kg");
+            return pause && pause(*this);
+        };
+        return DynamicSimulator::runUntil(dt, paused);
     }
 
-    void Simulator::run(double dt)
+    void Simulator::restore(const Snapshot &snapshot)
     {
-        double totalTime = 36000000000.0;
-        while (time_ < totalTime && !rocket_->isOutOfFuel() && !isArrived())
-        {
-            step(dt);
-        }
-
-        if (minDistance_ <= 1500.0) //* 1500 == default tolerance
-        {
-            Logger::info("Simulation stopped: Best approach at time: " + std::to_string(time_) +
-                         ", min distance: " + std::to_string(minDistance_) + " m");
-        }
-        else if (rocket_->isOutOfFuel())
-        {
-            Logger::warning("Simulation stopped: Rocket out of fuel at distance: " +
-                            std::to_string(minDistance_) + " m");
-        }
-        else
-        {
-            Logger::info("Simulation stopped: Maximum time reached, closest approach: " +
-                         std::to_string(minDistance_) + " m");
-        }
+        setAutopilot(snapshot.autopilot ? snapshot.autopilot->clone() : nullptr);
+        restoreProgress(snapshot);
     }
 
-    Rocket::RocketState Simulator::getRocketState() const
+    void Simulator::restore(const Snapshot &snapshot, std::shared_ptr<Autopilot> autopilot)
     {
-        return rocket_->getState();
+        setAutopilot(std::move(autopilot));
+        restoreProgress(snapshot);
     }
 
-    void Simulator::reset()
+    std::unique_ptr<Simulator> Simulator::fork(const Snapshot &snapshot, std::shared_ptr<Autopilot> autopilot) const
     {
-        time_ = 0.0;
-        minDistance_ = std::numeric_limits<double>::max();
-        wasClose_ = false;
-        rocket_->setPosition(Vector3(0, config::EARTH_RADIUS + 1.0, 0));
-        rocket_->setVelocity(Vector3(0, 0, 0));
-        rocket_->setThrustLevel(0.0);
+        auto copy = std::make_unique<Simulator>(*this);
+        copy->sharedRocket_ = std::make_shared<Rocket>(snapshot.rocket);
+        copy->rocket_ = copy->sharedRocket_.get();
+        copy->recorder_.reset();
+        copy->metrics_ = SimulationMetrics();
+        copy->setAutopilot(autopilot ? std::move(autopilot)
+                                     : (snapshot.autopilot ? snapshot.autopilot->clone() : nullptr));
+        copy->restoreProgress(snapshot);
+        return copy;
     }
 
     Vector3 Simulator::physicsToVisual(const Vector3 &physicalPos) const
@@ -219,4 +167,4 @@ namespace sim::core
         return state;
     }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,336 @@
+#include "../../include/core/trajectory_file.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace sim::core
+{
+
+    namespace trajectory_format
+    {
+        std::uint64_t chunkSize(std::uint64_t count)
+        {
+            std::uint64_t bytes = sizeof(ChunkHeader) +
+                                  count * (DOUBLE_COLUMNS * sizeof(double) + sizeof(std::uint64_t) + 2);
+            return (bytes + 7) & ~std::uint64_t(7);
+        }
+    }
+
+    using namespace trajectory_format;
+
+    namespace
+    {
+        template <typename T>
+        void writeColumn(std::ofstream &out, const std::vector<T> &column)
+        {
+            out.write(reinterpret_cast<const char *>(column.data()),
+                      static_cast<std::streamsize>(column.size() * sizeof(T)));
+        }
+    }
+
+    ColumnarTrajectorySink::ColumnarTrajectorySink(const std::string &path, std::size_t chunkCapacity)
+        : out_(path, std::ios::binary | std::ios::trunc), chunkCapacity_(std::max<std::size_t>(chunkCapacity, 1))
+    {
+        if (!out_)
+        {
+            throw std::runtime_error("Cannot open trajectory file: " + path);
+        }
+        for (auto &column : doubles_)
+        {
+            column.reserve(chunkCapacity_);
+        }
+        steps_.reserve(chunkCapacity_);
+        phases_.reserve(chunkCapacity_);
+        burnedOut_.reserve(chunkCapacity_);
+        writeHeader();
+    }
+
+    ColumnarTrajectorySink::~ColumnarTrajectorySink()
+    {
+        close();
+    }
+
+    void ColumnarTrajectorySink::write(const TrajectoryRecord *records, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const TrajectoryRecord &r = records[i];
+            doubles_[Time].push_back(r.time);
+            doubles_[PositionX].push_back(r.position[0]);
+            doubles_[PositionY].push_back(r.position[1]);
+            doubles_[PositionZ].push_back(r.position[2]);
+            doubles_[VelocityX].push_back(r.velocity[0]);
+            doubles_[VelocityY].push_back(r.velocity[1]);
+            doubles_[VelocityZ].push_back(r.velocity[2]);
+            doubles_[ThrustX].push_back(r.thrustDirection[0]);
+            doubles_[ThrustY].push_back(r.thrustDirection[1]);
+            doubles_[ThrustZ].push_back(r.thrustDirection[2]);
+            doubles_[FuelMass].push_back(r.fuelMass);
+            doubles_[TotalMass].push_back(r.totalMass);
+            doubles_[ThrustLevel].push_back(r.thrustLevel);
+            steps_.push_back(r.step);
+            phases_.push_back(static_cast<std::uint8_t>(r.phase));
+            burnedOut_.push_back(static_cast<std::uint8_t>(r.burnedOut));
+
+            if (steps_.size() == chunkCapacity_)
+            {
+                writeChunk();
+            }
+        }
+    }
+
+    void ColumnarTrajectorySink::writeChunk()
+    {
+        std::uint64_t count = steps_.size();
+        if (count == 0)
+        {
+            return;
+        }
+
+        ChunkHeader header{count, doubles_[Time].front(), doubles_[Time].back(), chunkSize(count)};
+        out_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        for (auto &column : doubles_)
+        {
+            writeColumn(out_, column);
+            column.clear();
+        }
+        writeColumn(out_, steps_);
+        writeColumn(out_, phases_);
+        writeColumn(out_, burnedOut_);
+        steps_.clear();
+        phases_.clear();
+        burnedOut_.clear();
+
+        static const char padding[8] = {};
+        std::uint64_t written = sizeof(ChunkHeader) + count * (DOUBLE_COLUMNS * sizeof(double) + sizeof(std::uint64_t) + 2);
+        out_.write(padding, static_cast<std::streamsize>(header.byteSize - written));
+
+        recordCount_ += count;
+        ++chunkCount_;
+    }
+
+    void ColumnarTrajectorySink::writeHeader()
+    {
+        FileHeader header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.byteOrderMark = BYTE_ORDER_MARK;
+        header.recordCount = recordCount_;
+        header.chunkCount = chunkCount_;
+
+        std::streampos end = out_.tellp();
+        out_.seekp(0);
+        out_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        if (end > std::streampos(sizeof(header)))
+        {
+            out_.seekp(end);
+        }
+    }
+
+    void ColumnarTrajectorySink::flush()
+    {
+        if (!out_.is_open())
+        {
+            return;
+        }
+        writeChunk();
+        writeHeader();
+        out_.flush();
+    }
+
+    void ColumnarTrajectorySink::close()
+    {
+        flush();
+        out_.close();
+    }
+
+    TrajectoryRecord TrajectoryChunk::record(std::size_t i) const
+    {
+        const Span<double> *c = columns;
+        return {c[Time][i],
+                {c[PositionX][i], c[PositionY][i], c[PositionZ][i]},
+                {c[VelocityX][i], c[VelocityY][i], c[VelocityZ][i]},
+                {c[ThrustX][i], c[ThrustY][i], c[ThrustZ][i]},
+                c[FuelMass][i],
+                c[TotalMass][i],
+                c[ThrustLevel][i],
+                step[i],
+                phase[i],
+                burnedOut[i]};
+    }
+
+    Rocket::RocketState TrajectoryChunk::state(std::size_t i) const
+    {
+        const Span<double> *c = columns;
+        return {Vector3(c[PositionX][i], c[PositionY][i], c[PositionZ][i]),
+                Vector3(c[VelocityX][i], c[VelocityY][i], c[VelocityZ][i]),
+                Vector3(c[ThrustX][i], c[ThrustY][i], c[ThrustZ][i]),
+                c[FuelMass][i],
+                c[ThrustLevel][i],
+                c[TotalMass][i]};
+    }
+
+    TrajectoryChunk TrajectoryChunk::slice(std::size_t offset, std::size_t count) const
+    {
+        TrajectoryChunk result;
+        for (int c = 0; c < DOUBLE_COLUMNS; ++c)
+        {
+            result.columns[c] = columns[c].subspan(offset, count);
+        }
+        result.step = step.subspan(offset, count);
+        result.phase = phase.subspan(offset, count);
+        result.burnedOut = burnedOut.subspan(offset, count);
+        return result;
+    }
+
+    TrajectoryFile::TrajectoryFile(const std::string &path)
+    {
+#if defined(_WIN32)
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in)
+        {
+            throw std::runtime_error("Cannot open trajectory file: " + path);
+        }
+        fallback_.resize(static_cast<std::size_t>(in.tellg()));
+        in.seekg(0);
+        in.read(reinterpret_cast<char *>(fallback_.data()), static_cast<std::streamsize>(fallback_.size()));
+        data_ = fallback_.data();
+        size_ = fallback_.size();
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::runtime_error("Cannot open trajectory file: " + path);
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("Cannot read trajectory file: " + path);
+        }
+        size_ = static_cast<std::size_t>(info.st_size);
+        if (size_ > 0)
+        {
+            void *mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED)
+            {
+                ::close(fd);
+                throw std::runtime_error("Cannot map trajectory file: " + path);
+            }
+            data_ = static_cast<const unsigned char *>(mapping);
+        }
+        ::close(fd);
+#endif
+
+        FileHeader header{};
+        if (size_ >= sizeof(header))
+        {
+            std::memcpy(&header, data_, sizeof(header));
+        }
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0)
+        {
+            unmap();
+            throw std::runtime_error("Not a trajectory file: " + path);
+        }
+        if (header.byteOrderMark != BYTE_ORDER_MARK || header.version != VERSION)
+        {
+            unmap();
+            throw std::runtime_error("Unsupported trajectory file version or byte order: " + path);
+        }
+
+        // Walk the chunks; a truncated last chunk (writer still running or killed) is ignored
+        std::size_t offset = sizeof(FileHeader);
+        while (offset + sizeof(ChunkHeader) <= size_)
+        {
+            ChunkHeader chunk;
+            std::memcpy(&chunk, data_ + offset, sizeof(chunk));
+            if (chunk.count == 0 || chunk.byteSize != chunkSize(chunk.count) ||
+                chunk.byteSize > size_ - offset)
+            {
+                break;
+            }
+
+            std::size_t n = static_cast<std::size_t>(chunk.count);
+            const unsigned char *column = data_ + offset + sizeof(ChunkHeader);
+            TrajectoryChunk view;
+            for (int c = 0; c < DOUBLE_COLUMNS; ++c)
+            {
+                view.columns[c] = Span<double>(reinterpret_cast<const double *>(column), n);
+                column += n * sizeof(double);
+            }
+            view.step = Span<std::uint64_t>(reinterpret_cast<const std::uint64_t *>(column), n);
+            column += n * sizeof(std::uint64_t);
+            view.phase = Span<std::uint8_t>(column, n);
+            view.burnedOut = Span<std::uint8_t>(column + n, n);
+
+            chunks_.push_back(view);
+            recordCount_ += n;
+            offset += static_cast<std::size_t>(chunk.byteSize);
+        }
+    }
+
+    TrajectoryFile::~TrajectoryFile()
+    {
+        unmap();
+    }
+
+    void TrajectoryFile::unmap()
+    {
+#if !defined(_WIN32)
+        if (data_ && size_ > 0)
+        {
+            ::munmap(const_cast<unsigned char *>(data_), size_);
+        }
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    std::size_t TrajectoryFile::recordCount() const
+    {
+        return recordCount_;
+    }
+
+    std::size_t TrajectoryFile::chunkCount() const
+    {
+        return chunks_.size();
+    }
+
+    const TrajectoryChunk &TrajectoryFile::chunk(std::size_t index) const
+    {
+        return chunks_.at(index);
+    }
+
+    std::vector<TrajectoryChunk> TrajectoryFile::range(double from, double to) const
+    {
+        std::vector<TrajectoryChunk> result;
+        if (!(from <= to))
+        {
+            return result;
+        }
+
+        // First chunk whose last record is not before `from`
+        auto first = std::partition_point(chunks_.begin(), chunks_.end(),
+                                          [from](const TrajectoryChunk &c)
+                                          { return c.time().back() < from; });
+        for (auto it = first; it != chunks_.end() && it->time().front() <= to; ++it)
+        {
+            Span<double> time = it->time();
+            std::size_t begin = static_cast<std::size_t>(std::lower_bound(time.begin(), time.end(), from) - time.begin());
+            std::size_t end = static_cast<std::size_t>(std::upper_bound(time.begin(), time.end(), to) - time.begin());
+            if (begin < end)
+            {
+                result.push_back(it->slice(begin, end - begin));
+            }
+        }
+        return result;
+    }
+
+} // namespace sim::core
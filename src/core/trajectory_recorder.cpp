@@ -0,0 +1,178 @@
+#include "../../include/core/trajectory_recorder.hpp"
+#include <chrono>
+#include <stdexcept>
+
+namespace sim::core
+{
+
+    namespace
+    {
+        // Records moved to the sink per write call
+        constexpr std::size_t WRITE_BATCH = 1024;
+        // How long the writer sleeps when the ring is empty
+        constexpr std::chrono::milliseconds IDLE_WAIT(2);
+    }
+
+    CsvTrajectorySink::CsvTrajectorySink(const std::string &path)
+        : out_(path)
+    {
+        if (!out_)
+        {
+            throw std::runtime_error("Cannot open trajectory file: " + path);
+        }
+        out_.precision(17);
+        out_ << "time,step,phase,burned_out,x,y,z,vx,vy,vz,tx,ty,tz,fuel,total_mass,thrust_level\n";
+    }
+
+    void CsvTrajectorySink::write(const TrajectoryRecord *records, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const TrajectoryRecord &r = records[i];
+            out_ << r.time << ',' << r.step << ',' << r.phase << ',' << r.burnedOut << ','
+                 << r.position[0] << ',' << r.position[1] << ',' << r.position[2] << ','
+                 << r.velocity[0] << ',' << r.velocity[1] << ',' << r.velocity[2] << ','
+                 << r.thrustDirection[0] << ',' << r.thrustDirection[1] << ',' << r.thrustDirection[2] << ','
+                 << r.fuelMass << ',' << r.totalMass << ',' << r.thrustLevel << '\n';
+        }
+    }
+
+    void CsvTrajectorySink::flush()
+    {
+        out_.flush();
+    }
+
+    TrajectoryRecorder::TrajectoryRecorder(std::unique_ptr<TrajectorySink> sink,
+                                           std::size_t decimation,
+                                           std::size_t capacity,
+                                           OverflowPolicy overflow)
+        : sink_(std::move(sink)), ring_(capacity), decimation_(decimation), overflow_(overflow)
+    {
+        if (!sink_)
+        {
+            throw std::invalid_argument("TrajectoryRecorder needs a sink");
+        }
+        if (decimation_ == 0)
+        {
+            throw std::invalid_argument("Decimation must be at least 1");
+        }
+        writer_ = std::thread(&TrajectoryRecorder::writerLoop, this);
+    }
+
+    TrajectoryRecorder::~TrajectoryRecorder()
+    {
+        close();
+    }
+
+    void TrajectoryRecorder::record(const Rocket &rocket, double time, std::uint64_t step,
+                                    std::int32_t phase, bool force)
+    {
+        if (stopping_.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+
+        std::int32_t burnedOut = rocket.isOutOfFuel() ? 1 : 0;
+        bool changed = !hasLast_ || phase != lastPhase_ || burnedOut != lastBurnedOut_;
+        if (!force && !changed && step % decimation_ != 0)
+        {
+            return;
+        }
+        // A forced record of a state that was already kept
+        if (hasLast_ && time == lastTime_ && !changed)
+        {
+            return;
+        }
+
+        hasLast_ = true;
+        lastPhase_ = phase;
+        lastBurnedOut_ = burnedOut;
+        lastTime_ = time;
+
+        const Rocket::RocketState state = rocket.getState();
+        TrajectoryRecord r{time,
+                           {state.position.x(), state.position.y(), state.position.z()},
+                           {state.velocity.x(), state.velocity.y(), state.velocity.z()},
+                           {state.thrustDirection.x(), state.thrustDirection.y(), state.thrustDirection.z()},
+                           state.fuelMass,
+                           state.totalMass,
+                           state.thrustLevel,
+                           step,
+                           phase,
+                           burnedOut};
+
+        bool pushed = ring_.tryPush(r);
+        if (!pushed && overflow_ == OverflowPolicy::Block)
+        {
+            // The writer wakes up within IDLE_WAIT and frees a slot
+            do
+            {
+                std::this_thread::yield();
+            } while (!(pushed = ring_.tryPush(r)));
+        }
+
+        if (pushed)
+        {
+            recorded_.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void TrajectoryRecorder::writerLoop()
+    {
+        std::vector<TrajectoryRecord> batch(WRITE_BATCH);
+        while (true)
+        {
+            // Read the flag first: once it is set, everything pushed before close()
+            // is already in the ring and the drain below sees it
+            bool stopping = stopping_.load(std::memory_order_acquire);
+
+            std::size_t count;
+            while ((count = ring_.popInto(batch.data(), batch.size())) > 0)
+            {
+                sink_->write(batch.data(), count);
+            }
+
+            if (stopping)
+            {
+                sink_->flush();
+                return;
+            }
+            std::this_thread::sleep_for(IDLE_WAIT);
+        }
+    }
+
+    void TrajectoryRecorder::close()
+    {
+        if (!writer_.joinable())
+        {
+            return;
+        }
+        stopping_.store(true, std::memory_order_release);
+        writer_.join();
+    }
+
+    std::size_t TrajectoryRecorder::decimation() const
+    {
+        return decimation_;
+    }
+
+    TrajectoryRecorder::OverflowPolicy TrajectoryRecorder::overflowPolicy() const
+    {
+        return overflow_;
+    }
+
+    std::size_t TrajectoryRecorder::recorded() const
+    {
+        return recorded_.load(std::memory_order_relaxed);
+    }
+
+    std::size_t TrajectoryRecorder::dropped() const
+    {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+} // namespace sim::core
@@ -1,6 +1,8 @@
 #include "../../include/physics/aerodynamics.hpp"
 #include "../../include/utils/config.hpp"
+#include <algorithm>
 #include <cmath>
+#include <iterator>
 
 using namespace sim::utils::config;
 
@@ -12,6 +14,81 @@ namespace sim::aerodynamics
         return SEA_LEVEL_AIR_DENSITY * exp(-altitude / SCALE_HEIGHT);
     }
 
+    namespace
+    {
+        struct AtmosphereLayer
+        {
+            double baseHeight;      // geopotential, m
+            double baseTemperature; // K
+            double lapseRate;       // K/m
+            double basePressure;    // Pa
+        };
+
+        constexpr AtmosphereLayer STANDARD_LAYERS[] = {
+            {0.0, 288.15, -0.0065, 101325.0},
+            {11000.0, 216.65, 0.0, 22632.06},
+            {20000.0, 216.65, 0.001, 5474.889},
+            {32000.0, 228.65, 0.0028, 868.0187},
+            {47000.0, 270.65, 0.0, 110.9063},
+            {51000.0, 270.65, -0.0028, 66.93887},
+            {71000.0, 214.65, -0.002, 3.956420},
+        };
+
+        // Published densities above 86 km, where the layer model no longer applies
+        struct DensityPoint
+        {
+            double altitude; // geometric, m
+            double density;  // kg/m3
+        };
+
+        constexpr DensityPoint UPPER_DENSITIES[] = {
+            {86000.0, 6.958e-6},
+            {90000.0, 3.416e-6},
+            {95000.0, 1.393e-6},
+            {100000.0, 5.604e-7},
+        };
+
+        constexpr double GAS_CONSTANT = 8.31432;      // J/(mol K)
+        constexpr double MOLAR_MASS = 0.0289644;      // kg/mol
+        constexpr double STANDARD_GRAVITY = 9.80665;  // m/s2
+        constexpr double GEOPOTENTIAL_RADIUS = 6356766.0; // m
+    }
+
+    double computeStandardAtmosphereDensity(double altitude)
+    {
+        altitude = std::max(altitude, 0.0);
+
+        if (altitude >= UPPER_DENSITIES[0].altitude)
+        {
+            const DensityPoint *upper = std::begin(UPPER_DENSITIES) + 1;
+            while (upper + 1 != std::end(UPPER_DENSITIES) && upper->altitude < altitude)
+            {
+                ++upper;
+            }
+            const DensityPoint *lower = upper - 1;
+            double t = (altitude - lower->altitude) / (upper->altitude - lower->altitude);
+            return lower->density * std::pow(upper->density / lower->density, t);
+        }
+
+        double height = GEOPOTENTIAL_RADIUS * altitude / (GEOPOTENTIAL_RADIUS + altitude);
+
+        const AtmosphereLayer *layer = std::begin(STANDARD_LAYERS);
+        while (layer + 1 != std::end(STANDARD_LAYERS) && (layer + 1)->baseHeight <= height)
+        {
+            ++layer;
+        }
+
+        double dh = height - layer->baseHeight;
+        double temperature = layer->baseTemperature + layer->lapseRate * dh;
+        double exponent = STANDARD_GRAVITY * MOLAR_MASS / GAS_CONSTANT;
+        double pressure = layer->lapseRate == 0.0
+                              ? layer->basePressure * std::exp(-exponent * dh / layer->baseTemperature)
+                              : layer->basePressure * std::pow(layer->baseTemperature / temperature,
+                                                               exponent / layer->lapseRate);
+
+        return pressure * MOLAR_MASS / (GAS_CONSTANT * temperature);
+    }
+
     sim::core::Vector3 computeDragForce(const sim::core::Vector3 &pos,
                                         const sim::core::Vector3 &velocity,
                                         double dragCoefficient,
@@ -23,7 +100,8 @@ namespace sim::aerodynamics
             alt = 0;
         }
         double rho = computeAtmosphericDensity(alt);
-        double v = velocity.length();
+        double v;
+        sim::core::Vector3 direction = velocity.normalizedWithLength(v);
 
         if (v < 1e-10)
         {
@@ -31,6 +109,6 @@ namespace sim::aerodynamics
         }
 
         double drag = 0.5 * dragCoefficient * rho * v * v * area;
-        return velocity.normalized() * (-drag);
+        return direction * (-drag);
     }
 }
\ No newline at end of file
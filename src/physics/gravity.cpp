@@ -4,21 +4,16 @@ using namespace sim::utils::config;
 
 namespace sim::physics
 {
-    double computeGravity(double alt)
+    sim::core::Vector3 computeGravityForce(const sim::core::Vector3 &pos, double mass)
     {
-        double r = EARTH_RADIUS + alt;
-        return G * EARTH_MASS / (r * r);
-    }
-
-    Vector3 computeGravityForce(const Vector3 &pos, double mass)
-    {
-
-        double alt = pos.length() - EARTH_RADIUS;
+        double r;
+        sim::core::Vector3 direction = pos.normalizedWithLength(r);
+        double alt = r - EARTH_RADIUS;
         if (alt < 0)
         {
             alt = 0;
         }
         double g = computeGravity(alt);
-        return pos.normalized() * (-g * mass);
+        return direction * (-g * mass);
     }
 }
\ No newline at end of file
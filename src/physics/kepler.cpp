@@ -0,0 +1,299 @@
+#include "../../include/physics/kepler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using sim::core::Vector3;
+using sim::utils::config::PI;
+
+namespace sim::physics
+{
+
+    namespace
+    {
+        constexpr double TWO_PI = 2.0 * PI;
+        constexpr double NOT_FOUND = std::numeric_limits<double>::quiet_NaN();
+        constexpr int MAX_ITERATIONS = 50;
+        constexpr double TOLERANCE = 1e-14;
+
+        // Anomalies sampled before the closest approach is refined
+        constexpr int APPROACH_SAMPLES = 128;
+
+        // First value of base + k * 2 pi strictly after `after`
+        double nextTurn(double base, double after)
+        {
+            double value = base + TWO_PI * std::ceil((after - base) / TWO_PI);
+            return value <= after ? value + TWO_PI : value;
+        }
+    }
+
+    double solveKepler(double meanAnomaly, double eccentricity)
+    {
+        double E = eccentricity < 0.8 ? meanAnomaly : (meanAnomaly < 0.0 ? -PI : PI);
+        for (int i = 0; i < MAX_ITERATIONS; ++i)
+        {
+            double delta = (E - eccentricity * std::sin(E) - meanAnomaly) /
+                           (1.0 - eccentricity * std::cos(E));
+            E -= delta;
+            if (std::abs(delta) < TOLERANCE * (1.0 + std::abs(E)))
+            {
+                break;
+            }
+        }
+        return E;
+    }
+
+    double solveHyperbolicKepler(double meanAnomaly, double eccentricity)
+    {
+        double H = std::copysign(std::log(2.0 * std::abs(meanAnomaly) / eccentricity + 1.8), meanAnomaly);
+        for (int i = 0; i < MAX_ITERATIONS; ++i)
+        {
+            double delta = (eccentricity * std::sinh(H) - H - meanAnomaly) /
+                           (eccentricity * std::cosh(H) - 1.0);
+            H -= delta;
+            if (std::abs(delta) < TOLERANCE * (1.0 + std::abs(H)))
+            {
+                break;
+            }
+        }
+        return H;
+    }
+
+    KeplerOrbit::KeplerOrbit(const Vector3 &position, const Vector3 &velocity, double mu)
+        : mu_(mu), a_(0.0), e_(0.0), meanMotion_(0.0), initialAnomaly_(0.0), initialMeanAnomaly_(0.0)
+    {
+        double r = position.length();
+        Vector3 h = position.cross(velocity);
+        double hLength = h.length();
+        double circularSpeed = std::sqrt(mu / r);
+
+        a_ = 1.0 / (2.0 / r - velocity.dot(velocity) / mu);
+        Vector3 eccentricityVector = velocity.cross(h) / mu - position / r;
+        e_ = eccentricityVector.length();
+
+        // Radial trajectories have no orbital plane, and near e = 1 neither form of
+        // Kepler's equation is well conditioned
+        if (!(r > 0.0) || hLength < 1e-9 * r * circularSpeed || std::abs(1.0 - e_) < 1e-6 ||
+            !std::isfinite(a_))
+        {
+            return;
+        }
+
+        p_ = e_ > 1e-10 ? eccentricityVector / e_ : position / r;
+        q_ = (h / hLength).cross(p_);
+
+        double x = position.dot(p_);
+        double y = position.dot(q_);
+        double absA = std::abs(a_);
+        meanMotion_ = std::sqrt(mu / (absA * absA * absA));
+
+        if (isBound())
+        {
+            initialAnomaly_ = std::atan2(y / (a_ * std::sqrt(1.0 - e_ * e_)), x / a_ + e_);
+            initialMeanAnomaly_ = initialAnomaly_ - e_ * std::sin(initialAnomaly_);
+        }
+        else
+        {
+            initialAnomaly_ = std::asinh(y / (absA * std::sqrt(e_ * e_ - 1.0)));
+            initialMeanAnomaly_ = e_ * std::sinh(initialAnomaly_) - initialAnomaly_;
+        }
+
+        valid_ = true;
+    }
+
+    bool KeplerOrbit::isValid() const
+    {
+        return valid_;
+    }
+
+    bool KeplerOrbit::isBound() const
+    {
+        return e_ < 1.0;
+    }
+
+    double KeplerOrbit::eccentricity() const
+    {
+        return e_;
+    }
+
+    double KeplerOrbit::semiMajorAxis() const
+    {
+        return a_;
+    }
+
+    double KeplerOrbit::periapsis() const
+    {
+        return std::abs(a_) * std::abs(1.0 - e_);
+    }
+
+    double KeplerOrbit::period() const
+    {
+        return isBound() ? TWO_PI / meanMotion_ : std::numeric_limits<double>::infinity();
+    }
+
+    double KeplerOrbit::initialAnomaly() const
+    {
+        return initialAnomaly_;
+    }
+
+    double KeplerOrbit::radiusAt(double anomaly) const
+    {
+        if (isBound())
+        {
+            return a_ * (1.0 - e_ * std::cos(anomaly));
+        }
+        return -a_ * (e_ * std::cosh(anomaly) - 1.0);
+    }
+
+    Vector3 KeplerOrbit::positionAt(double anomaly) const
+    {
+        if (isBound())
+        {
+            return p_ * (a_ * (std::cos(anomaly) - e_)) +
+                   q_ * (a_ * std::sqrt(1.0 - e_ * e_) * std::sin(anomaly));
+        }
+        double absA = -a_;
+        return p_ * (absA * (e_ - std::cosh(anomaly))) +
+               q_ * (absA * std::sqrt(e_ * e_ - 1.0) * std::sinh(anomaly));
+    }
+
+    KeplerOrbit::State KeplerOrbit::stateAt(double anomaly) const
+    {
+        double r = radiusAt(anomaly);
+        Vector3 velocity;
+        if (isBound())
+        {
+            double scale = std::sqrt(mu_ * a_) / r;
+            velocity = (p_ * -std::sin(anomaly) + q_ * (std::sqrt(1.0 - e_ * e_) * std::cos(anomaly))) * scale;
+        }
+        else
+        {
+            double scale = std::sqrt(-mu_ * a_) / r;
+            velocity = (p_ * -std::sinh(anomaly) + q_ * (std::sqrt(e_ * e_ - 1.0) * std::cosh(anomaly))) * scale;
+        }
+        return {positionAt(anomaly), velocity};
+    }
+
+    double KeplerOrbit::timeAt(double anomaly) const
+    {
+        double meanAnomaly = isBound() ? anomaly - e_ * std::sin(anomaly)
+                                       : e_ * std::sinh(anomaly) - anomaly;
+        return (meanAnomaly - initialMeanAnomaly_) / meanMotion_;
+    }
+
+    double KeplerOrbit::anomalyAtTime(double time) const
+    {
+        double meanAnomaly = initialMeanAnomaly_ + meanMotion_ * time;
+        if (!isBound())
+        {
+            return solveHyperbolicKepler(meanAnomaly, e_);
+        }
+
+        // Solve on (-pi, pi] and add the completed turns back
+        double turns = std::floor((meanAnomaly + PI) / TWO_PI);
+        return solveKepler(meanAnomaly - turns * TWO_PI, e_) + turns * TWO_PI;
+    }
+
+    double KeplerOrbit::descendingCrossing(double radius) const
+    {
+        if (!valid_ || radius <= periapsis())
+        {
+            return NOT_FOUND;
+        }
+
+        if (isBound())
+        {
+            if (radius >= a_ * (1.0 + e_))
+            {
+                return NOT_FOUND;
+            }
+            double base = TWO_PI - std::acos((1.0 - radius / a_) / e_);
+            return nextTurn(base, initialAnomaly_);
+        }
+
+        double anomaly = -std::acosh((1.0 - radius / a_) / e_);
+        return anomaly > initialAnomaly_ ? anomaly : NOT_FOUND;
+    }
+
+    double KeplerOrbit::ascendingCrossing(double radius) const
+    {
+        if (!valid_ || radius <= periapsis())
+        {
+            return NOT_FOUND;
+        }
+
+        if (isBound())
+        {
+            if (radius >= a_ * (1.0 + e_))
+            {
+                return NOT_FOUND;
+            }
+            double base = std::acos((1.0 - radius / a_) / e_);
+            return nextTurn(base, initialAnomaly_);
+        }
+
+        double anomaly = std::acosh((1.0 - radius / a_) / e_);
+        return anomaly > initialAnomaly_ ? anomaly : NOT_FOUND;
+    }
+
+    ClosestApproach findClosestApproach(const KeplerOrbit &orbit, const Vector3 &target,
+                                        double fromAnomaly, double toAnomaly)
+    {
+        auto distance = [&](double anomaly)
+        {
+            return (orbit.positionAt(anomaly) - target).length();
+        };
+
+        toAnomaly = std::max(toAnomaly, fromAnomaly);
+        double spacing = (toAnomaly - fromAnomaly) / APPROACH_SAMPLES;
+
+        ClosestApproach best{fromAnomaly, distance(fromAnomaly)};
+        int bestSample = 0;
+        for (int i = 1; i <= APPROACH_SAMPLES; ++i)
+        {
+            double anomaly = i == APPROACH_SAMPLES ? toAnomaly : fromAnomaly + spacing * i;
+            double d = distance(anomaly);
+            if (d < best.distance)
+            {
+                best = {anomaly, d};
+                bestSample = i;
+            }
+        }
+
+        // Golden-section search between the neighbours of the best sample
+        const double ratio = 0.5 * (std::sqrt(5.0) - 1.0);
+        double lo = std::max(fromAnomaly, fromAnomaly + spacing * (bestSample - 1));
+        double hi = std::min(toAnomaly, fromAnomaly + spacing * (bestSample + 1));
+        double c = hi - ratio * (hi - lo);
+        double d = lo + ratio * (hi - lo);
+        double fc = distance(c);
+        double fd = distance(d);
+        for (int i = 0; i < 200 && hi - lo > TOLERANCE * (1.0 + std::abs(lo)); ++i)
+        {
+            if (fc < fd)
+            {
+                hi = d;
+                d = c;
+                fd = fc;
+                c = hi - ratio * (hi - lo);
+                fc = distance(c);
+            }
+            else
+            {
+                lo = c;
+                c = d;
+                fc = fd;
+                d = lo + ratio * (hi - lo);
+                fd = distance(d);
+            }
+        }
+
+        double anomaly = 0.5 * (lo + hi);
+        double refined = distance(anomaly);
+        if (refined < best.distance)
+        {
+            best = {anomaly, refined};
+        }
+        return best;
+    }
+}
@@ -1,86 +1,332 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
-#include <sstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#ifdef HAVE_TERMCOLOR
 #include <termcolor/termcolor.hpp>
+#endif
 #include "../../include/utils/logger.hpp"
+#include "../../include/utils/spsc_ring.hpp"
+
+// Browsers without SharedArrayBuffer have no threads to drain on
+#if defined(USE_EMSCRIPTEN) && !defined(__EMSCRIPTEN_PTHREADS__)
+#define SIM_LOG_SYNCHRONOUS 1
+#endif
 
 namespace sim::utils
 {
 
-    static LogLevel currentLogLevel = LogLevel::Debug;
+    namespace
+    {
+        constexpr std::size_t RECORD_TEXT = 500;     // longer messages are cut short
+        constexpr std::size_t BUFFER_RECORDS = 1024; // per thread
+        constexpr std::chrono::milliseconds DRAIN_INTERVAL(5);
+
+        std::atomic<LogLevel> currentLogLevel{LogLevel::Debug};
+        thread_local int muteDepth = 0;
+
+        struct LogRecord
+        {
+            LogLevel level;
+            std::uint16_t length;
+            char text[RECORD_TEXT];
+        };
+
+        struct ThreadBuffer
+        {
+            SpscRing<LogRecord> ring{BUFFER_RECORDS};
+            std::atomic<bool> retired{false};
+            std::atomic<std::size_t> dropped{0};
+        };
+
+        void writeLine(LogLevel level, const std::string &message)
+        {
+            const char *levelText = "";
+            switch (level)
+            {
+            case LogLevel::Debug:
+                levelText = "DEBUG";
+                break;
+            case LogLevel::Info:
+                levelText = "INFO";
+                break;
+            case LogLevel::Warning:
+                levelText = "WARN";
+                break;
+            case LogLevel::Error:
+                levelText = "ERROR";
+                break;
+            case LogLevel::None:
+                return;
+            }
+
+            std::cout << "[";
+#ifdef HAVE_TERMCOLOR
+            switch (level)
+            {
+            case LogLevel::Debug:
+                std::cout << termcolor::cyan << levelText << termcolor::reset;
+                break;
+            case LogLevel::Info:
+                std::cout << termcolor::green << levelText << termcolor::reset;
+                break;
+            case LogLevel::Warning:
+                std::cout << termcolor::yellow << levelText << termcolor::reset;
+                break;
+            case LogLevel::Error:
+                std::cout << termcolor::red << levelText << termcolor::reset;
+                break;
+            case LogLevel::None:
+                break;
+            }
+#else
+            std::cout << levelText;
+#endif
+            std::cout << "] " << message << '\n';
+        }
+
+        // Set once the backend below has been destroyed at exit; later messages are
+        // written directly. Trivially destructible, so it outlives every other static.
+        std::atomic<bool> backendDown{false};
+
+        class Backend
+        {
+        private:
+            std::mutex registryMutex_;
+            std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+
+            std::mutex drainMutex_; // one consumer per ring at a time
+            std::atomic<bool> stopping_{false};
+            std::thread drainer_;
+
+            void drainLoop()
+            {
+                while (!stopping_.load(std::memory_order_acquire))
+                {
+                    std::this_thread::sleep_for(DRAIN_INTERVAL);
+                    drain();
+                }
+            }
+
+            static void drainBuffer(ThreadBuffer &buffer)
+            {
+                LogRecord records[64];
+                std::size_t count;
+                while ((count = buffer.ring.popInto(records, 64)) > 0)
+                {
+                    for (std::size_t i = 0; i < count; ++i)
+                    {
+                        writeLine(records[i].level, std::string(records[i].text, records[i].length));
+                    }
+                }
+
+                if (std::size_t dropped = buffer.dropped.exchange(0))
+                {
+                    writeLine(LogLevel::Warning, std::to_string(dropped) + " log messages dropped, buffer full");
+                }
+            }
+
+        public:
+            ~Backend()
+            {
+                stopping_.store(true, std::memory_order_release);
+                if (drainer_.joinable())
+                {
+                    drainer_.join();
+                }
+                drain();
+                backendDown.store(true);
+            }
+
+            std::shared_ptr<ThreadBuffer> registerThread()
+            {
+                auto buffer = std::make_shared<ThreadBuffer>();
+                std::lock_guard<std::mutex> lock(registryMutex_);
+                buffers_.push_back(buffer);
+                if (!drainer_.joinable())
+                {
+                    drainer_ = std::thread(&Backend::drainLoop, this);
+                }
+                return buffer;
+            }
+
+            void drain()
+            {
+                std::lock_guard<std::mutex> drainLock(drainMutex_);
+
+                std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+                {
+                    std::lock_guard<std::mutex> lock(registryMutex_);
+                    buffers = buffers_;
+                }
+
+                std::vector<std::shared_ptr<ThreadBuffer>> retired;
+                for (auto &buffer : buffers)
+                {
+                    // Read before draining: a retired thread pushes nothing afterwards
+                    if (buffer->retired.load(std::memory_order_acquire))
+                    {
+                        retired.push_back(buffer);
+                    }
+                    drainBuffer(*buffer);
+                }
+                std::cout.flush();
+
+                if (!retired.empty())
+                {
+                    std::lock_guard<std::mutex> lock(registryMutex_);
+                    buffers_.erase(std::remove_if(buffers_.begin(), buffers_.end(),
+                                                  [&](const std::shared_ptr<ThreadBuffer> &b)
+                                                  { return std::find(retired.begin(), retired.end(), b) != retired.end(); }),
+                                   buffers_.end());
+                }
+            }
+        };
+
+        Backend &backend()
+        {
+            static Backend instance;
+            return instance;
+        }
+
+        // Marks the buffer of an exiting thread for removal once it is drained
+        struct ThreadBufferHandle
+        {
+            std::shared_ptr<ThreadBuffer> buffer;
+
+            ~ThreadBufferHandle()
+            {
+                if (buffer)
+                {
+                    buffer->retired.store(true, std::memory_order_release);
+                }
+            }
+        };
+
+        ThreadBuffer &threadBuffer()
+        {
+            thread_local ThreadBufferHandle handle;
+            if (!handle.buffer)
+            {
+                handle.buffer = backend().registerThread();
+            }
+            return *handle.buffer;
+        }
+    }
 
     void Logger::setLevel(LogLevel level)
     {
-        currentLogLevel = level;
+        currentLogLevel.store(level, std::memory_order_relaxed);
     }
 
-    void Logger::log(const std::string &message, LogLevel level)
+    LogLevel Logger::level()
     {
-        if (level < currentLogLevel || currentLogLevel == LogLevel::None)
+        return currentLogLevel.load(std::memory_order_relaxed);
+    }
+
+    bool Logger::isEnabled(LogLevel level)
+    {
+        LogLevel current = currentLogLevel.load(std::memory_order_relaxed);
+        return muteDepth == 0 && level >= current && current != LogLevel::None;
+    }
+
+    void Logger::write(LogLevel level, const std::string &message)
+    {
+#if defined(SIM_LOG_SYNCHRONOUS)
+        writeLine(level, message);
+        std::cout.flush();
+#else
+        if (backendDown.load(std::memory_order_relaxed))
         {
+            writeLine(level, message);
+            std::cout.flush();
             return;
         }
 
-        std::string levelText;
+        LogRecord record;
+        record.level = level;
+        record.length = static_cast<std::uint16_t>(std::min(RECORD_TEXT, message.size()));
+        std::memcpy(record.text, message.data(), record.length);
 
-        switch (level)
+        ThreadBuffer &buffer = threadBuffer();
+        if (!buffer.ring.tryPush(record))
         {
-        case LogLevel::None:
-            return;
-        case LogLevel::Debug:
-            levelText = "DEBUG";
-            break;
-        case LogLevel::Info:
-            levelText = "INFO";
-            break;
-        case LogLevel::Warning:
-            levelText = "WARN";
-            break;
-        case LogLevel::Error:
-            levelText = "ERROR";
-            break;
-        default:
-            throw std::invalid_argument("Invalid log level");
+            buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (level == LogLevel::Error)
+        {
+            flush();
         }
+#endif
+    }
 
-        std::cout << "[";
+    void Logger::log(const std::string &message, LogLevel level)
+    {
         switch (level)
         {
-        case LogLevel::None:
-            return;
         case LogLevel::Debug:
-            std::cout << termcolor::cyan << levelText << termcolor::reset;
+            format<LogLevel::Debug>(message);
             break;
         case LogLevel::Info:
-            std::cout << termcolor::green << levelText << termcolor::reset;
+            format<LogLevel::Info>(message);
             break;
         case LogLevel::Warning:
-            std::cout << termcolor::yellow << levelText << termcolor::reset;
+            format<LogLevel::Warning>(message);
             break;
         case LogLevel::Error:
-            std::cout << termcolor::red << levelText << termcolor::reset;
+            format<LogLevel::Error>(message);
+            break;
+        case LogLevel::None:
             break;
         }
-        std::cout << "] " << message << std::endl;
     }
 
     void Logger::debug(const std::string &message)
     {
-        log(message, LogLevel::Debug);
+        format<LogLevel::Debug>(message);
     }
 
     void Logger::info(const std::string &message)
     {
-        log(message, LogLevel::Info);
+        format<LogLevel::Info>(message);
     }
 
     void Logger::warning(const std::string &message)
     {
-        log(message, LogLevel::Warning);
+        format<LogLevel::Warning>(message);
     }
 
     void Logger::error(const std::string &message)
     {
-        log(message, LogLevel::Error);
+        format<LogLevel::Error>(message);
+    }
+
+    void Logger::flush()
+    {
+#if !defined(SIM_LOG_SYNCHRONOUS)
+        if (!backendDown.load(std::memory_order_relaxed))
+        {
+            backend().drain();
+        }
+#endif
+        std::cout.flush();
+    }
+
+    Logger::ScopedMute::ScopedMute()
+    {
+        ++muteDepth;
+    }
+
+    Logger::ScopedMute::~ScopedMute()
+    {
+        --muteDepth;
     }
 
 }
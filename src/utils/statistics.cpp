@@ -0,0 +1,161 @@
+#include "../../include/utils/statistics.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace sim::utils
+{
+
+    namespace
+    {
+        // Bucket i holds (GAMMA^(i-1), GAMMA^i]; its midpoint is within
+        // RELATIVE_ACCURACY of everything in it
+        const double GAMMA = (1.0 + QuantileSketch::RELATIVE_ACCURACY) / (1.0 - QuantileSketch::RELATIVE_ACCURACY);
+        const double LOG_GAMMA = std::log(GAMMA);
+        const long FIRST_INDEX = static_cast<long>(std::ceil(std::log(QuantileSketch::MIN_VALUE) / LOG_GAMMA));
+        const long LAST_INDEX = static_cast<long>(std::ceil(std::log(QuantileSketch::MAX_VALUE) / LOG_GAMMA));
+    }
+
+    void RunningStats::add(double value)
+    {
+        ++count_;
+        double delta = value - mean_;
+        mean_ += delta / static_cast<double>(count_);
+        m2_ += delta * (value - mean_);
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+
+    void RunningStats::merge(const RunningStats &other)
+    {
+        if (other.count_ == 0)
+        {
+            return;
+        }
+        if (count_ == 0)
+        {
+            *this = other;
+            return;
+        }
+
+        double n = static_cast<double>(count_ + other.count_);
+        double delta = other.mean_ - mean_;
+        mean_ += delta * static_cast<double>(other.count_) / n;
+        m2_ += other.m2_ + delta * delta * static_cast<double>(count_) * static_cast<double>(other.count_) / n;
+        count_ += other.count_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    std::uint64_t RunningStats::count() const
+    {
+        return count_;
+    }
+
+    double RunningStats::mean() const
+    {
+        return mean_;
+    }
+
+    double RunningStats::variance() const
+    {
+        return count_ < 2 ? 0.0 : m2_ / static_cast<double>(count_ - 1);
+    }
+
+    double RunningStats::standardDeviation() const
+    {
+        return std::sqrt(variance());
+    }
+
+    double RunningStats::min() const
+    {
+        return min_;
+    }
+
+    double RunningStats::max() const
+    {
+        return max_;
+    }
+
+    long QuantileSketch::bucketOf(double value)
+    {
+        long index = static_cast<long>(std::ceil(std::log(value) / LOG_GAMMA));
+        return std::clamp(index, FIRST_INDEX, LAST_INDEX);
+    }
+
+    double QuantileSketch::valueOf(long bucket)
+    {
+        return 2.0 * std::pow(GAMMA, static_cast<double>(bucket)) / (GAMMA + 1.0);
+    }
+
+    void QuantileSketch::add(double value)
+    {
+        if (std::isnan(value))
+        {
+            return;
+        }
+
+        ++count_;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+        if (value < MIN_VALUE)
+        {
+            ++zeroCount_;
+        }
+        else
+        {
+            ++buckets_[bucketOf(value)];
+        }
+    }
+
+    void QuantileSketch::merge(const QuantileSketch &other)
+    {
+        for (const auto &[bucket, count] : other.buckets_)
+        {
+            buckets_[bucket] += count;
+        }
+        zeroCount_ += other.zeroCount_;
+        count_ += other.count_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+    }
+
+    std::uint64_t QuantileSketch::count() const
+    {
+        return count_;
+    }
+
+    double QuantileSketch::quantile(double q) const
+    {
+        if (count_ == 0)
+        {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        if (q <= 0.0)
+        {
+            return min_;
+        }
+        if (q >= 1.0)
+        {
+            return max_;
+        }
+
+        // The value of the given rank (0-based) in sorted order
+        auto rank = static_cast<std::uint64_t>(q * static_cast<double>(count_ - 1));
+        if (rank < zeroCount_)
+        {
+            return std::clamp(0.0, min_, max_);
+        }
+
+        std::uint64_t seen = zeroCount_;
+        for (const auto &[bucket, count] : buckets_)
+        {
+            seen += count;
+            if (seen > rank)
+            {
+                return std::clamp(valueOf(bucket), min_, max_);
+            }
+        }
+        return max_;
+    }
+
+} // namespace sim::utils
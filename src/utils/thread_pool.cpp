@@ -0,0 +1,171 @@
+#include "../../include/utils/thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+
+namespace sim::utils
+{
+
+    namespace
+    {
+        // Shared between the caller of parallelFor and the runners it queued. Runners that
+        // start after every index has been claimed only touch this block, never the task.
+        struct ParallelForState
+        {
+            std::size_t count = 0;
+            const std::function<void(std::size_t)> *task = nullptr;
+            std::atomic<std::size_t> next{0};
+            std::size_t completed = 0;
+            std::exception_ptr error;
+            std::mutex mutex;
+            std::condition_variable done;
+
+            void drain()
+            {
+                std::size_t finished = 0;
+                std::exception_ptr localError;
+                for (std::size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+                {
+                    try
+                    {
+                        (*task)(i);
+                    }
+                    catch (...)
+                    {
+                        if (!localError)
+                        {
+                            localError = std::current_exception();
+                        }
+                    }
+                    ++finished;
+                }
+
+                if (finished == 0)
+                {
+                    return;
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                if (localError && !error)
+                {
+                    error = localError;
+                }
+                completed += finished;
+                if (completed == count)
+                {
+                    done.notify_all();
+                }
+            }
+        };
+    }
+
+    ThreadPool::ThreadPool(std::size_t threadCount)
+    {
+        if (threadCount == 0)
+        {
+            threadCount = defaultThreadCount();
+        }
+#if defined(USE_EMSCRIPTEN) && !defined(__EMSCRIPTEN_PTHREADS__)
+        // WebAssembly without pthreads cannot start threads; the caller does all the work
+        threadCount = 1;
+#endif
+
+        // The caller of parallelFor works as well, so one thread fewer is spawned
+        workers_.reserve(threadCount - 1);
+        for (std::size_t i = 1; i < threadCount; ++i)
+        {
+            workers_.emplace_back(&ThreadPool::workerLoop, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        condition_.notify_all();
+
+        for (auto &worker : workers_)
+        {
+            worker.join();
+        }
+    }
+
+    std::size_t ThreadPool::size() const
+    {
+        return workers_.size() + 1;
+    }
+
+    std::size_t ThreadPool::defaultThreadCount()
+    {
+#if defined(USE_EMSCRIPTEN) && !defined(__EMSCRIPTEN_PTHREADS__)
+        return 1;
+#else
+        return std::max(1u, std::thread::hardware_concurrency());
+#endif
+    }
+
+    void ThreadPool::enqueue(std::function<void()> task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        condition_.notify_one();
+    }
+
+    void ThreadPool::workerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                condition_.wait(lock, [this]
+                                { return stopping_ || !tasks_.empty(); });
+
+                if (stopping_ && tasks_.empty())
+                {
+                    return;
+                }
+
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+    void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)> &task)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        auto state = std::make_shared<ParallelForState>();
+        state->count = count;
+        state->task = &task;
+
+        std::size_t runners = std::min(workers_.size(), count - 1);
+        for (std::size_t i = 0; i < runners; ++i)
+        {
+            enqueue([state]
+                    { state->drain(); });
+        }
+
+        state->drain();
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done.wait(lock, [&state]
+                         { return state->completed == state->count; });
+
+        if (state->error)
+        {
+            std::rethrow_exception(state->error);
+        }
+    }
+
+} // namespace sim::utils